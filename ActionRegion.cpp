@@ -0,0 +1,129 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "ActionRegion.h"
+#include <math.h>
+#include <string>
+
+using namespace dronecode_sdk;
+
+namespace cdra {
+
+  void ActionRegion::addHalfSpace(float north, float east, float down, float bound) {
+    if(north == 0 && east == 0 && down == 0) {
+      // Degenerate constraint: 0 <= bound
+      if(bound < 0) {
+	empty = true;
+      }
+      return;
+    }
+    halfSpaces.push_back({north, east, down, bound});
+  }
+
+  void ActionRegion::addSlab(float north, float east, float down, float lower, float upper) {
+    if(lower > upper) {
+      empty = true;
+      return;
+    }
+    addHalfSpace(north, east, down, upper);
+    addHalfSpace(-north, -east, -down, -lower);
+  }
+
+  void ActionRegion::intersect(const ActionRegion& other) {
+    empty = empty || other.empty;
+    halfSpaces.insert(halfSpaces.end(), other.halfSpaces.begin(), other.halfSpaces.end());
+  }
+
+  bool ActionRegion::contains(const Offboard::VelocityNEDYaw& v, float tolerance) const {
+    if(empty) {
+      return false;
+    }
+    for(auto& h : halfSpaces) {
+      if(h.north*v.north_m_s + h.east*v.east_m_s + h.down*v.down_m_s > h.bound + tolerance) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  bool ActionRegion::closestPoint(const Offboard::VelocityNEDYaw& target, float maxSpeed,
+				  Offboard::VelocityNEDYaw& out, int iterations) const {
+    out = target;
+    if(empty) {
+      return false;
+    }
+
+    // Dykstra's algorithm: cyclic projections onto each half-space and the
+    // speed ball, with one correction term per set; converges to the
+    // projection of "target" onto their intersection
+    int num_sets = halfSpaces.size() + 1;
+    std::vector<double> corrections(3 * num_sets, 0);
+    double x[3] = { target.north_m_s, target.east_m_s, target.down_m_s };
+
+    for(int it = 0; it < iterations; it++) {
+      for(int s = 0; s < num_sets; s++) {
+	double* p = &corrections[3 * s];
+	double y[3] = { x[0] + p[0], x[1] + p[1], x[2] + p[2] };
+	if(s < (int)halfSpaces.size()) {
+	  const HalfSpace& h = halfSpaces[s];
+	  double a[3] = { h.north, h.east, h.down };
+	  double excess = a[0]*y[0] + a[1]*y[1] + a[2]*y[2] - h.bound;
+	  double norm2  = a[0]*a[0] + a[1]*a[1] + a[2]*a[2];
+	  double step   = excess > 0 ? excess / norm2 : 0;
+	  for(int k = 0; k < 3; k++) {
+	    x[k] = y[k] - step * a[k];
+	  }
+	} else {
+	  double norm  = sqrt(y[0]*y[0] + y[1]*y[1] + y[2]*y[2]);
+	  double scale = norm > maxSpeed ? maxSpeed / norm : 1;
+	  for(int k = 0; k < 3; k++) {
+	    x[k] = y[k] * scale;
+	  }
+	}
+	for(int k = 0; k < 3; k++) {
+	  p[k] = y[k] - x[k];
+	}
+      }
+    }
+
+    out.north_m_s = x[0];
+    out.east_m_s  = x[1];
+    out.down_m_s  = x[2];
+    float speed = sqrt(x[0]*x[0] + x[1]*x[1] + x[2]*x[2]);
+    return contains(out, 1e-3) && speed <= maxSpeed + 1e-3;
+  }
+
+  std::string ActionRegion::str() const {
+    if(empty) {
+      return "{}";
+    }
+    std::string s;
+    for(auto& h : halfSpaces) {
+      s += "[" + std::to_string(h.north) + ", " + std::to_string(h.east) + ", " +
+	std::to_string(h.down) + "] . v <= " + std::to_string(h.bound) + "\n";
+    }
+    return s;
+  }
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_ACTIONREGION_H
+#define MISSIONAPP_ACTIONREGION_H
+
+#include <dronecode_sdk/offboard.h>
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A convex region of commanded velocities (NED, m/s), described as an
+   * intersection of half-spaces
+   *   north * v.north_m_s + east * v.east_m_s + down * v.down_m_s <= bound
+   * An empty list of half-spaces is the whole velocity space.
+   * Signal functions export the region of actions that keep their
+   * proposition satisfied (see SigFun::feasibleActions), and coordinators
+   * intersect the regions of several properties.
+   */
+  class ActionRegion {
+  public:
+    struct HalfSpace {
+      float north, east, down;
+      float bound;
+    };
+
+  private:
+    std::vector<HalfSpace> halfSpaces;
+    bool empty = false;
+
+  public:
+    // Restricts the region to the half-space n . v <= bound
+    void addHalfSpace(float north, float east, float down, float bound);
+    // Restricts the region to lower <= n . v <= upper
+    void addSlab(float north, float east, float down, float lower, float upper);
+    // Marks the region as empty (no action satisfies it)
+    void setEmpty() { empty = true; };
+    // true iff the region is known to be empty
+    bool isEmpty() const { return empty; };
+    // true iff the region does not constrain the action at all
+    bool isUnconstrained() const { return !empty && halfSpaces.empty(); };
+    const std::vector<HalfSpace>& getHalfSpaces() const { return halfSpaces; };
+
+    // Restricts this region to its intersection with "other"
+    void intersect(const ActionRegion& other);
+    // true iff "v" satisfies every half-space (up to "tolerance")
+    bool contains(const dronecode_sdk::Offboard::VelocityNEDYaw& v, float tolerance = 1e-4) const;
+    /**
+     * Computes the point of the region within "maxSpeed" of the origin
+     * that is closest to "target" (Dykstra's alternating projections).
+     * Returns false if the region is empty or no such point was found
+     * within "iterations" rounds; "out" then holds the last iterate.
+     */
+    bool closestPoint(const dronecode_sdk::Offboard::VelocityNEDYaw& target, float maxSpeed,
+		      dronecode_sdk::Offboard::VelocityNEDYaw& out, int iterations = 200) const;
+    std::string str() const;
+  };
+
+}
+
+#endif //MISSIONAPP_ACTIONREGION_H
@@ -0,0 +1,722 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <math.h>
+#include <vector>
+
+#include "ActionScorer.h"
+#include "DroneUtil.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+
+namespace cdra {
+
+  /* The follower's pursuit law (see run_follower): the enemy's velocity
+   * command toward the ego drone, "delta" (ego - enemy position) away, at
+   * ENEMY_DRONE_SPEED -- or hovering once it caught the ego drone */
+  static inline void pursuitCommand(float delta_north, float delta_east, float delta_down,
+				    float& north, float& east, float& down) {
+    if(!droneutil::FOLLOWER_Z_VELOCITY) {
+      delta_down = 0;
+    }
+    float diag = sqrt(delta_north*delta_north + delta_east*delta_east + delta_down*delta_down);
+    float scale = diag < droneutil::CATCH_DISTANCE ? 0 : droneutil::ENEMY_DRONE_SPEED / diag;
+    north = scale * delta_north;
+    east  = scale * delta_east;
+    down  = scale * delta_down;
+  }
+
+  /* Advances both drones of "state" (a row) together, a tick at a time, for
+   * "horizon" ticks: the ego drone holds "action" while the enemy re-aims at
+   * it every tick, both moving as "model" predicts */
+  static void rolloutJoint(const DroneModel& model, float* state,
+			   const dronecode_sdk::Offboard::VelocityNEDYaw& action,
+			   float horizon = droneutil::TICKS_TO_CORRECT) {
+    dronecode_sdk::Offboard::VelocityNEDYaw pursuit{0, 0, 0, 0};
+    for(float done = 0; done < horizon; done += 1) {
+      float ticks = min(1.0f, horizon - done);
+      pursuitCommand(state[StateBatch::POS_NORTH] - state[StateBatch::ENEMY_POS_NORTH],
+		     state[StateBatch::POS_EAST]  - state[StateBatch::ENEMY_POS_EAST],
+		     state[StateBatch::POS_DOWN]  - state[StateBatch::ENEMY_POS_DOWN],
+		     pursuit.north_m_s, pursuit.east_m_s, pursuit.down_m_s);
+      model.step(state, action, ticks, DroneModel::EGO);
+      model.step(state, pursuit, ticks, DroneModel::ENEMY);
+    }
+  }
+
+  /* Predicts the enemy's position and velocity ("enemy": ENEMY_POS_* then
+   * ENEMY_VEL_* of the current state) as it turns to chase the ego drone's
+   * predicted position, its velocity changing as "model" predicts, into
+   * "next" (same layout) -- the estimate used without JOINT_ROLLOUT */
+  static void predictEnemy(const DroneModel& model, const float* enemy,
+			   float new_pos_east, float new_pos_north, float new_pos_down,
+			   float* next) {
+    const float td = droneutil::TICK_DURATION;
+    const int POS_EAST = 0, POS_NORTH = 1, POS_DOWN = 2, VEL_EAST = 3, VEL_NORTH = 4, VEL_DOWN = 5;
+
+    dronecode_sdk::Offboard::VelocityNEDYaw enemy_vel{
+      enemy[VEL_EAST],
+	enemy[VEL_NORTH],
+	enemy[VEL_DOWN],
+	0
+	};
+
+    int ticks_in_old_dir = 2;
+  
+    /* Enemy goes N ticks in the old direction */
+    float new_enemy_pos_east  = enemy[POS_EAST]  +
+      enemy_vel.east_m_s*td*ticks_in_old_dir;
+    float new_enemy_pos_north = enemy[POS_NORTH] +
+      enemy_vel.north_m_s*td*ticks_in_old_dir;
+    float new_enemy_pos_down  = enemy[POS_DOWN]  +
+      enemy_vel.down_m_s*td*ticks_in_old_dir;
+
+    /* NOTE: This makes 'side' moves less effective */
+    const float delta_east  = new_pos_east  - new_enemy_pos_east;
+    const float delta_north = new_pos_north - new_enemy_pos_north;
+    const float delta_down  = new_pos_down  - new_enemy_pos_down;
+  
+    const float delta = sqrt(pow(delta_east , 2.0) +
+			     pow(delta_north, 2.0) +
+			     pow(delta_down , 2.0));
+
+    const int enemy_speed = droneutil::ENEMY_DRONE_SPEED;
+
+    Offboard::VelocityNEDYaw attempted_enemy_vel{
+      enemy_speed*(delta_north/delta),
+	enemy_speed*(delta_east/delta),
+	enemy_speed*(delta_down/delta)
+	};
+  
+    /* Its velocity turns toward it as the model predicts */
+    float turned[StateBatch::NUM_CHANNELS] = {};
+    std::copy(enemy, enemy + 6, turned + StateBatch::ENEMY_POS_EAST);
+    model.step(turned, attempted_enemy_vel, droneutil::TICKS_TO_CORRECT-ticks_in_old_dir, DroneModel::ENEMY);
+    Offboard::VelocityNEDYaw new_enemy_action{
+      turned[StateBatch::ENEMY_VEL_NORTH],
+	turned[StateBatch::ENEMY_VEL_EAST],
+	turned[StateBatch::ENEMY_VEL_DOWN],
+	0
+	};
+    /* This will update the enemy position further -- Currently leaving the enemy position largely the same...
+       new_enemy_pos_east  +=
+       (((new_enemy_action.east_m_s))  * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
+       new_enemy_pos_north +=
+       (((new_enemy_action.north_m_s)) * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
+       new_enemy_pos_down  +=
+       (((new_enemy_action.down_m_s))  * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
+    */
+    next[POS_EAST]  = new_enemy_pos_east;
+    next[POS_NORTH] = new_enemy_pos_north;
+    next[POS_DOWN]  = new_enemy_pos_down;
+    next[VEL_EAST]  = new_enemy_action.east_m_s;
+    next[VEL_NORTH] = new_enemy_action.north_m_s;
+    next[VEL_DOWN]  = new_enemy_action.down_m_s;
+  }
+
+  void predictState(const DroneModel& model,
+		    const float* current,
+		    const dronecode_sdk::Offboard::VelocityNEDYaw& target_action,
+		    float* state) {
+    // NOTE: Giving inaccurate position/velocity estimates for next state -- accuracy only really matters with respect to robustness relative to other potential actions. i.e., as long as this estimate roughly maintains the ordering of r(a_1') ... r(a_n') we're okay.
+    float next[StateBatch::NUM_CHANNELS];
+    std::copy(current, current + StateBatch::NUM_CHANNELS, next);
+    if(droneutil::JOINT_ROLLOUT) {
+      rolloutJoint(model, next, target_action);
+    } else {
+      model.step(next, target_action, droneutil::TICKS_TO_CORRECT);
+      predictEnemy(model, current + StateBatch::ENEMY_POS_EAST,
+		   next[StateBatch::POS_EAST], next[StateBatch::POS_NORTH], next[StateBatch::POS_DOWN],
+		   next + StateBatch::ENEMY_POS_EAST);
+    }
+    std::copy(next, next + StateBatch::NUM_CHANNELS, state);
+  }
+
+  void predictState(const DroneModel& model,
+		    Signal* cur_signal,
+		    const dronecode_sdk::Offboard::VelocityNEDYaw& target_action,
+		    float* state) {
+    const auto& names = StateBatch::channelNames();
+    float current[StateBatch::NUM_CHANNELS];
+    for(int c = 0; c < StateBatch::NUM_CHANNELS; c++) {
+      current[c] = cur_signal->value(names[c]);
+    }
+    predictState(model, current, target_action, state);
+  }
+
+  void predictNextTick(const DroneModel& model,
+		       const float* current,
+		       const dronecode_sdk::Offboard::VelocityNEDYaw& action,
+		       float* state) {
+    std::copy(current, current + StateBatch::NUM_CHANNELS, state);
+    rolloutJoint(model, state, action, 1);
+  }
+
+  void predictStates(const DroneModel& model, StateBatch& states,
+		     const float* north, const float* east, const float* down,
+		     std::vector<float>& pursuit) {
+    if(droneutil::JOINT_ROLLOUT) {
+      // Same as rolloutJoint, a channel at a time for the whole batch
+      int n = states.size();
+      pursuit.resize(3 * n);
+      float* pursuit_north = pursuit.data();
+      float* pursuit_east  = pursuit_north + n;
+      float* pursuit_down  = pursuit_east + n;
+      const float* pos_north = states.data(StateBatch::POS_NORTH);
+      const float* pos_east  = states.data(StateBatch::POS_EAST);
+      const float* pos_down  = states.data(StateBatch::POS_DOWN);
+      const float* enemy_north = states.data(StateBatch::ENEMY_POS_NORTH);
+      const float* enemy_east  = states.data(StateBatch::ENEMY_POS_EAST);
+      const float* enemy_down  = states.data(StateBatch::ENEMY_POS_DOWN);
+      for(float done = 0; done < droneutil::TICKS_TO_CORRECT; done += 1) {
+	float ticks = min(1.0f, droneutil::TICKS_TO_CORRECT - done);
+	for(int i = 0; i < n; i++) {
+	  pursuitCommand(pos_north[i] - enemy_north[i], pos_east[i] - enemy_east[i], pos_down[i] - enemy_down[i],
+			 pursuit_north[i], pursuit_east[i], pursuit_down[i]);
+	}
+	model.step(states, north, east, down, ticks, DroneModel::EGO);
+	model.step(states, pursuit_north, pursuit_east, pursuit_down, ticks, DroneModel::ENEMY);
+      }
+      return;
+    }
+
+    model.step(states, north, east, down, droneutil::TICKS_TO_CORRECT);
+
+    // The enemy reacts to each predicted position (the enemy channels still hold the current state)
+    const int E = StateBatch::ENEMY_POS_EAST;
+    float* enemy[6];
+    for(int c = 0; c < 6; c++) {
+      enemy[c] = states.data((StateBatch::Channel)(E + c));
+    }
+    const float* pos_east  = states.data(StateBatch::POS_EAST);
+    const float* pos_north = states.data(StateBatch::POS_NORTH);
+    const float* pos_down  = states.data(StateBatch::POS_DOWN);
+    float current[6], next[6];
+    for(int i = 0; i < states.size(); i++) {
+      for(int c = 0; c < 6; c++) {
+	current[c] = enemy[c][i];
+      }
+      predictEnemy(model, current, pos_east[i], pos_north[i], pos_down[i], next);
+      for(int c = 0; c < 6; c++) {
+	enemy[c][i] = next[c];
+      }
+    }
+  }
+
+  /* Bounds of the pursuit command (see pursuitCommand) over the drones' positions
+   * within the rows "lo" and "hi" */
+  static void pursuitBounds(const float* lo, const float* hi,
+			    dronecode_sdk::Offboard::VelocityNEDYaw& lower,
+			    dronecode_sdk::Offboard::VelocityNEDYaw& upper) {
+    const StateBatch::Channel ego[3] = { StateBatch::POS_NORTH, StateBatch::POS_EAST, StateBatch::POS_DOWN };
+    const StateBatch::Channel enemy[3] = { StateBatch::ENEMY_POS_NORTH, StateBatch::ENEMY_POS_EAST,
+					   StateBatch::ENEMY_POS_DOWN };
+    int num_axes = droneutil::FOLLOWER_Z_VELOCITY ? 3 : 2;
+    // Range of the delta along each axis, and of its square
+    float delta_lo[3] = {0, 0, 0}, delta_hi[3] = {0, 0, 0}, sq_min[3] = {0, 0, 0}, sq_max[3] = {0, 0, 0};
+    for(int k = 0; k < num_axes; k++) {
+      delta_lo[k] = lo[ego[k]] - hi[enemy[k]];
+      delta_hi[k] = hi[ego[k]] - lo[enemy[k]];
+      float nearest = delta_lo[k] > 0 ? delta_lo[k] : (delta_hi[k] < 0 ? -delta_hi[k] : 0);
+      sq_min[k] = nearest * nearest;
+      sq_max[k] = max(delta_lo[k] * delta_lo[k], delta_hi[k] * delta_hi[k]);
+    }
+    // Along an axis, delta / |delta| increases with the axis' delta and shrinks
+    // toward 0 as the other axes' deltas grow
+    auto direction = [](float x, float others) { return x == 0 ? 0 : x / sqrt(x*x + others); };
+    float cmd_lo[3], cmd_hi[3];
+    for(int k = 0; k < 3; k++) {
+      float others_min = 0, others_max = 0;
+      for(int j = 0; j < 3; j++) {
+	if(j != k) { others_min += sq_min[j]; others_max += sq_max[j]; }
+      }
+      cmd_lo[k] = droneutil::ENEMY_DRONE_SPEED * direction(delta_lo[k], delta_lo[k] < 0 ? others_min : others_max);
+      cmd_hi[k] = droneutil::ENEMY_DRONE_SPEED * direction(delta_hi[k], delta_hi[k] > 0 ? others_min : others_max);
+    }
+    if(sq_min[0] + sq_min[1] + sq_min[2] < droneutil::CATCH_DISTANCE * droneutil::CATCH_DISTANCE) {
+      // May have caught the ego drone (and hover)
+      for(int k = 0; k < 3; k++) {
+	cmd_lo[k] = min(cmd_lo[k], 0.0f);
+	cmd_hi[k] = max(cmd_hi[k], 0.0f);
+      }
+    }
+    lower = { cmd_lo[0], cmd_lo[1], cmd_lo[2], 0 };
+    upper = { cmd_hi[0], cmd_hi[1], cmd_hi[2], 0 };
+  }
+
+  void predictBounds(const DroneModel& model, const float* current,
+		     const dronecode_sdk::Offboard::VelocityNEDYaw& lower,
+		     const dronecode_sdk::Offboard::VelocityNEDYaw& upper,
+		     StateBounds& bounds) {
+    float* lo = bounds.lower;
+    float* hi = bounds.upper;
+    std::copy(current, current + StateBatch::NUM_CHANNELS, lo);
+    std::copy(current, current + StateBatch::NUM_CHANNELS, hi);
+    if(droneutil::JOINT_ROLLOUT) {
+      // As rolloutJoint, with the range of the pursuit commands of each tick
+      dronecode_sdk::Offboard::VelocityNEDYaw pursuit_lo, pursuit_hi;
+      for(float done = 0; done < droneutil::TICKS_TO_CORRECT; done += 1) {
+	float ticks = min(1.0f, droneutil::TICKS_TO_CORRECT - done);
+	pursuitBounds(lo, hi, pursuit_lo, pursuit_hi);
+	model.step(lo, lower, ticks, DroneModel::EGO);
+	model.step(hi, upper, ticks, DroneModel::EGO);
+	model.step(lo, pursuit_lo, ticks, DroneModel::ENEMY);
+	model.step(hi, pursuit_hi, ticks, DroneModel::ENEMY);
+      }
+      return;
+    }
+
+    model.step(lo, lower, droneutil::TICKS_TO_CORRECT);
+    model.step(hi, upper, droneutil::TICKS_TO_CORRECT);
+    // predictEnemy moves the enemy along its current velocity, whatever the action
+    float next[6];
+    predictEnemy(model, current + StateBatch::ENEMY_POS_EAST, 0, 0, 0, next);
+    for(int c = 0; c < 3; c++) {
+      lo[StateBatch::ENEMY_POS_EAST + c] = hi[StateBatch::ENEMY_POS_EAST + c] = next[c];
+      lo[StateBatch::ENEMY_VEL_EAST + c] = -std::numeric_limits<float>::infinity();
+      hi[StateBatch::ENEMY_VEL_EAST + c] = std::numeric_limits<float>::infinity();
+    }
+  }
+
+  ActionScorer::ActionScorer(const std::vector<StlExpr*>& properties,
+			     const std::vector<float>& weights,
+			     Signal* signal, int t, const DroneModel& model, ThreadPool* pool)
+    : weights(weights), signal(signal), t(t), model(model), pool(pool),
+      workspaces(pool ? pool->size() : 1) {
+    // Everything up to tick `t` is the same for every candidate, so fold the
+    // committed history into each property once and only score the residuals
+    int committed = signal->length();
+    batchable = true;
+    for(auto property : properties) {
+      StlExpr* residual = property->partialEval(signal, t+1, committed);
+      batchable = batchable && residual->batchable();
+      residuals.push_back(residual);
+    }
+    const auto& names = StateBatch::channelNames();
+    for(int c = 0; c < StateBatch::NUM_CHANNELS; c++) {
+      current[c] = signal->value(names[c]);
+    }
+
+    for(unsigned int i = 0; i < residuals.size(); i++) {
+      order.push_back(i);
+    }
+    for(auto& ws : workspaces) {
+      ws.cost.assign(residuals.size(), 0);
+      ws.samples.assign(residuals.size(), 0);
+    }
+  }
+
+  ActionScorer::~ActionScorer() {
+    for(auto residual : residuals) {
+      delete residual;
+    }
+  }
+
+  float ActionScorer::score(const Offboard::VelocityNEDYaw& action) {
+    return score(action, workspaces[0], nullptr);
+  }
+
+  float ActionScorer::score(const Offboard::VelocityNEDYaw& action, Workspace& ws, float* values) {
+    if(!ws.estSignal) {
+      ws.estSignal.reset(new Signal(*signal));
+    }
+    float state[StateBatch::NUM_CHANNELS];
+    predictState(model, current, action, state);
+    ws.estSignal->append(vector<float>(state, state + StateBatch::NUM_CHANNELS));
+
+    // Sum weighted robustness values for each property at time `t+1`
+    // Time t+1 because that includes the estimated signal
+    float global_rob = 0;
+    for(unsigned int i = 0; i < residuals.size(); i++) {
+      float rob = residuals[i]->robustness(ws.estSignal.get(), t+1);
+      if(values) {
+	values[i] = rob;
+      }
+      global_rob += weights[i] * rob;
+    }
+    ws.evaluated += residuals.size();
+    
+    // We want to reuse our estSignal, so we have to pop off the last element
+    ws.estSignal->pop();
+    return global_rob;
+  }
+
+  void ActionScorer::scoreRange(const vector<Offboard::VelocityNEDYaw>& actions,
+				int first, int last, float* scores, float* values, Workspace& ws) {
+    int num_props = residuals.size();
+    if(!(droneutil::BATCH_SCORING && batchable)) {
+      for(int i = first; i < last; i++) {
+	scores[i] = score(actions[i], ws, values ? values + i * num_props : nullptr);
+      }
+      return;
+    }
+
+    int n = last - first;
+    ws.batch.resize(n);
+    ws.north.resize(n);
+    ws.east.resize(n);
+    ws.down.resize(n);
+    for(int i = 0; i < n; i++) {
+      ws.batch.setRow(i, current);
+      ws.north[i] = actions[first + i].north_m_s;
+      ws.east[i]  = actions[first + i].east_m_s;
+      ws.down[i]  = actions[first + i].down_m_s;
+    }
+    predictStates(model, ws.batch, ws.north.data(), ws.east.data(), ws.down.data(), ws.pursuit);
+
+    // Same summation order as the single-action path
+    ws.robustness.resize(n);
+    for(int i = 0; i < n; i++) {
+      scores[first + i] = 0;
+    }
+    ws.evaluated += (unsigned long)n * num_props;
+    for(int p = 0; p < num_props; p++) {
+      residuals[p]->robustnessBatch(ws.batch, ws.robustness.data());
+      for(int i = 0; i < n; i++) {
+	scores[first + i] += weights[p] * ws.robustness[i];
+      }
+      if(values) {
+	for(int i = 0; i < n; i++) {
+	  values[(first + i) * num_props + p] = ws.robustness[i];
+	}
+      }
+    }
+  }
+
+  // An upper bound is only trusted this far (relative) below the threshold, as
+  // it is not summed in the same order as the score it bounds
+  static const float PRUNE_MARGIN = 1e-4;
+  // Evaluations of each residual timed per worker
+  static const unsigned long COST_SAMPLES = 64;
+
+  float ActionScorer::scorePruned(const Offboard::VelocityNEDYaw& action, Workspace& ws, float threshold) {
+    if(!ws.estSignal) {
+      ws.estSignal.reset(new Signal(*signal));
+    }
+    float state[StateBatch::NUM_CHANNELS];
+    predictState(model, current, action, state);
+    ws.estSignal->append(vector<float>(state, state + StateBatch::NUM_CHANNELS));
+
+    int num_props = residuals.size();
+    float cutoff = threshold - PRUNE_MARGIN * (1 + fabs(threshold));
+    float partial = 0;
+    ws.values.resize(num_props);
+    for(int k = 0; k < num_props; k++) {
+      int p = order[k];
+      if(ws.samples[p] < COST_SAMPLES) {
+	auto start = std::chrono::steady_clock::now();
+	ws.values[p] = residuals[p]->robustness(ws.estSignal.get(), t+1);
+	ws.cost[p] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	ws.samples[p]++;
+      } else {
+	ws.values[p] = residuals[p]->robustness(ws.estSignal.get(), t+1);
+      }
+      ws.evaluated++;
+      partial += weights[p] * ws.values[p];
+      float bound = partial + remaining[k + 1];
+      if(bound < cutoff) {
+	ws.pruned += num_props - k - 1;
+	ws.estSignal->pop();
+	return bound;
+      }
+    }
+    ws.estSignal->pop();
+
+    // Same summation order as without a threshold
+    float global_rob = 0;
+    for(int i = 0; i < num_props; i++) {
+      global_rob += weights[i] * ws.values[i];
+    }
+    return global_rob;
+  }
+
+  void ActionScorer::scoreAll(const vector<Offboard::VelocityNEDYaw>& actions,
+			      float* scores, float* values, float threshold) {
+    bool pruning = threshold > -std::numeric_limits<float>::infinity();
+    auto range = [&](int first, int last, Workspace& ws) {
+      if(pruning) {
+	for(int i = first; i < last; i++) {
+	  scores[i] = scorePruned(actions[i], ws, threshold);
+	}
+      } else {
+	scoreRange(actions, first, last, scores, values, ws);
+      }
+    };
+    int n = actions.size();
+    int chunks = (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    if(!pool || pool->size() < 2 || chunks < 2) {
+      range(0, n, workspaces[0]);
+      return;
+    }
+    // Chunks write disjoint ranges of "scores" and "values"
+    pool->parallelFor(chunks, [&](int chunk, int worker) {
+	int first = chunk * PARALLEL_CHUNK;
+	range(first, min(first + PARALLEL_CHUNK, n), workspaces[worker]);
+      });
+  }
+
+  void ActionScorer::reorder(const vector<Offboard::VelocityNEDYaw>& actions) {
+    // Bound each residual over the states after any action of the box around
+    // "actions" and every action up to MAX_DRONE_SPEED (so that they are
+    // rarely bounded again) or, failing that, over every state
+    float speed = droneutil::MAX_DRONE_SPEED;
+    Offboard::VelocityNEDYaw lower { -speed, -speed, -speed, 0 }, upper { speed, speed, speed, 0 };
+    for(auto& action : actions) {
+      lower = { min(lower.north_m_s, action.north_m_s), min(lower.east_m_s, action.east_m_s),
+		min(lower.down_m_s, action.down_m_s), 0 };
+      upper = { max(upper.north_m_s, action.north_m_s), max(upper.east_m_s, action.east_m_s),
+		max(upper.down_m_s, action.down_m_s), 0 };
+    }
+    int num_props = residuals.size();
+    if(!(bounded && lower.north_m_s >= boundedLower.north_m_s && lower.east_m_s >= boundedLower.east_m_s &&
+	 lower.down_m_s >= boundedLower.down_m_s && upper.north_m_s <= boundedUpper.north_m_s &&
+	 upper.east_m_s <= boundedUpper.east_m_s && upper.down_m_s <= boundedUpper.down_m_s)) {
+      StateBounds states;
+      predictBounds(model, current, lower, upper, states);
+      maxContribution.resize(num_props);
+      range.resize(num_props);
+      for(int p = 0; p < num_props; p++) {
+	float rob_lo, rob_hi;
+	if(residuals[p]->robustnessBounds(states, rob_lo, rob_hi) || residuals[p]->robustnessRange(rob_lo, rob_hi)) {
+	  maxContribution[p] = weights[p] * (weights[p] >= 0 ? rob_hi : rob_lo);
+	  range[p] = fabs(weights[p]) * (rob_hi - rob_lo);
+	} else {
+	  maxContribution[p] = range[p] = std::numeric_limits<float>::infinity();
+	}
+      }
+      bounded = true;
+      boundedLower = lower;
+      boundedUpper = upper;
+    }
+
+    // Residuals that narrow the bound the most per nanosecond first; those not
+    // timed yet count as free, so that they get timed
+    gain.resize(num_props);
+    for(int p = 0; p < num_props; p++) {
+      double cost = 0;
+      unsigned long samples = 0;
+      for(auto& ws : workspaces) {
+	cost += ws.cost[p];
+	samples += ws.samples[p];
+      }
+      gain[p] = samples > 0 && cost > 0 ? range[p] / (cost / samples) : std::numeric_limits<float>::infinity();
+    }
+    sort(order.begin(), order.end(), [this](int p1, int p2) {
+	return gain[p1] > gain[p2] || (gain[p1] == gain[p2] && p1 < p2);
+      });
+
+    remaining.assign(num_props + 1, 0);
+    for(int k = num_props - 1; k >= 0; k--) {
+      remaining[k] = remaining[k + 1] + maxContribution[order[k]];
+    }
+  }
+
+  void ActionScorer::score(const vector<Offboard::VelocityNEDYaw>& actions,
+			   vector<float>& scores) {
+    scores.assign(actions.size(), 0);
+    scoreAll(actions, scores.data(), nullptr, -std::numeric_limits<float>::infinity());
+  }
+
+  void ActionScorer::score(const vector<Offboard::VelocityNEDYaw>& actions,
+			   vector<float>& scores, vector<float>& values) {
+    scores.assign(actions.size(), 0);
+    values.assign(actions.size() * residuals.size(), 0);
+    scoreAll(actions, scores.data(), values.data(), -std::numeric_limits<float>::infinity());
+  }
+
+  void ActionScorer::score(const vector<Offboard::VelocityNEDYaw>& actions,
+			   vector<float>& scores, float threshold) {
+    // The batch kernels evaluate a residual for less than it takes to track
+    // which candidates to skip, so batches are scored in full
+    if(!droneutil::SHORT_CIRCUIT_SCORING || (droneutil::BATCH_SCORING && batchable)) {
+      threshold = -std::numeric_limits<float>::infinity();
+    }
+    scores.assign(actions.size(), 0);
+    if(threshold > -std::numeric_limits<float>::infinity()) {
+      reorder(actions);
+    }
+    scoreAll(actions, scores.data(), nullptr, threshold);
+  }
+
+  unsigned long ActionScorer::evaluations() const {
+    unsigned long evaluated = 0;
+    for(auto& ws : workspaces) {
+      evaluated += ws.evaluated;
+    }
+    return evaluated;
+  }
+
+  unsigned long ActionScorer::prunedEvaluations() const {
+    unsigned long pruned = 0;
+    for(auto& ws : workspaces) {
+      pruned += ws.pruned;
+    }
+    return pruned;
+  }
+
+  bool ActionScorer::bounds(const Offboard::VelocityNEDYaw& lower, const Offboard::VelocityNEDYaw& upper,
+			    float& lo, float& hi) {
+    StateBounds states;
+    predictBounds(model, current, lower, upper, states);
+    lo = hi = 0;
+    for(unsigned int i = 0; i < residuals.size(); i++) {
+      float rob_lo, rob_hi;
+      if(!residuals[i]->robustnessBounds(states, rob_lo, rob_hi)) {
+	return false;
+      }
+      lo += weights[i] * (weights[i] >= 0 ? rob_lo : rob_hi);
+      hi += weights[i] * (weights[i] >= 0 ? rob_hi : rob_lo);
+    }
+    return true;
+  }
+
+  bool ActionScorer::feasibleRegion(ActionRegion& region) {
+    // The residuals are evaluated at t+1, i.e., after holding the action
+    // for the prediction window from the latest committed state
+    float horizon = droneutil::TICK_DURATION * droneutil::TICKS_TO_CORRECT;
+    int latest = signal->length() - 1;
+    for(auto residual : residuals) {
+      if(!residual->feasibleActions(signal, latest, horizon, region)) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  SequenceScorer::SequenceScorer(const std::vector<StlExpr*>& properties,
+				 const std::vector<float>& weights,
+				 Signal* signal, int t, int steps, const DroneModel& model, ThreadPool* pool)
+    : weights(weights), signal(signal), t(t), steps(steps), model(model), pool(pool),
+      workspaces(pool ? pool->size() : 1) {
+    int committed = signal->length();
+    batchable = true;
+    residuals.resize(steps);
+    for(int k = 0; k < steps; k++) {
+      for(auto property : properties) {
+	StlExpr* residual = property->partialEval(signal, t+1+k, committed);
+	batchable = batchable && residual->batchable();
+	residuals[k].push_back(residual);
+      }
+    }
+    const auto& names = StateBatch::channelNames();
+    for(int c = 0; c < StateBatch::NUM_CHANNELS; c++) {
+      current[c] = signal->value(names[c]);
+    }
+  }
+
+  SequenceScorer::~SequenceScorer() {
+    for(auto& step : residuals) {
+      for(auto residual : step) {
+	delete residual;
+      }
+    }
+  }
+
+  void SequenceScorer::scoreRange(const vector<Offboard::VelocityNEDYaw>& sequences,
+				  int first, int last, float* scores, Workspace& ws) {
+    const int C = StateBatch::NUM_CHANNELS;
+    int n = last - first;
+    int num_props = weights.size();
+    ws.minimum.resize(n * num_props);
+
+    if(!(droneutil::BATCH_SCORING && batchable)) {
+      ws.states.resize(n * C);
+      if(!ws.estSignal) {
+	ws.estSignal.reset(new Signal(*signal));
+      }
+      float next[StateBatch::NUM_CHANNELS];
+      for(int i = 0; i < n; i++) {
+	float* state = ws.states.data() + i * C;
+	for(int k = 0; k < steps; k++) {
+	  predictState(model, k == 0 ? current : state, sequences[(first + i) * steps + k], next);
+	  std::copy(next, next + C, state);
+	  ws.estSignal->append(vector<float>(state, state + C));
+	  for(int p = 0; p < num_props; p++) {
+	    float r = residuals[k][p]->robustness(ws.estSignal.get(), t+1+k);
+	    ws.minimum[i*num_props + p] = k == 0 ? r : min(ws.minimum[i*num_props + p], r);
+	  }
+	}
+	for(int k = 0; k < steps; k++) {
+	  ws.estSignal->pop();
+	}
+      }
+    } else {
+      // Roll the whole batch out in place, a step at a time
+      ws.batch.resize(n);
+      ws.robustness.resize(n);
+      ws.north.resize(n);
+      ws.east.resize(n);
+      ws.down.resize(n);
+      for(int i = 0; i < n; i++) {
+	ws.batch.setRow(i, current);
+      }
+      for(int k = 0; k < steps; k++) {
+	for(int i = 0; i < n; i++) {
+	  const auto& action = sequences[(first + i) * steps + k];
+	  ws.north[i] = action.north_m_s;
+	  ws.east[i]  = action.east_m_s;
+	  ws.down[i]  = action.down_m_s;
+	}
+	predictStates(model, ws.batch, ws.north.data(), ws.east.data(), ws.down.data(), ws.pursuit);
+	for(int p = 0; p < num_props; p++) {
+	  residuals[k][p]->robustnessBatch(ws.batch, ws.robustness.data());
+	  for(int i = 0; i < n; i++) {
+	    float r = ws.robustness[i];
+	    ws.minimum[i*num_props + p] = k == 0 ? r : min(ws.minimum[i*num_props + p], r);
+	  }
+	}
+      }
+    }
+
+    for(int i = 0; i < n; i++) {
+      float global_rob = 0;
+      for(int p = 0; p < num_props; p++) {
+	global_rob += weights[p] * ws.minimum[i*num_props + p];
+      }
+      scores[first + i] = global_rob;
+    }
+  }
+
+  void SequenceScorer::score(const vector<Offboard::VelocityNEDYaw>& sequences,
+			     vector<float>& scores) {
+    int n = sequences.size() / steps;
+    scores.assign(n, 0);
+
+    int chunks = (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    if(!pool || pool->size() < 2 || chunks < 2) {
+      scoreRange(sequences, 0, n, scores.data(), workspaces[0]);
+      return;
+    }
+    // Chunks write disjoint ranges of "scores"
+    pool->parallelFor(chunks, [&](int chunk, int worker) {
+	int first = chunk * PARALLEL_CHUNK;
+	scoreRange(sequences, first, min(first + PARALLEL_CHUNK, n), scores.data(), workspaces[worker]);
+      });
+  }
+  
+}
@@ -0,0 +1,247 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_ACTIONSCORER_H
+#define MISSIONAPP_ACTIONSCORER_H
+
+#include <dronecode_sdk/offboard.h>
+#include <memory>
+#include <vector>
+#include "Signal.h"
+#include "StlExpr.h"
+#include "StateBatch.h"
+#include "ActionRegion.h"
+#include "DroneModel.h"
+#include "ThreadPool.h"
+
+namespace cdra {
+
+    /**
+     * Scores candidate actions by the weighted sum of the robustness of a
+     * set of properties at the tick after performing the action, as
+     * predicted with a DroneModel.
+     *
+     * The properties are partially evaluated against the committed signal
+     * once, at construction; each candidate is then only scored against the
+     * residual expressions over the estimated tick. When every residual
+     * only reads the estimated tick, candidates are scored in batches with
+     * the signal functions' batch kernels.
+     *
+     * Given a thread pool, a set of candidates is split into chunks scored
+     * in parallel, each worker with its own buffers. Every candidate's
+     * score is computed exactly as in the serial path, so the scores do
+     * not depend on the number of workers.
+     *
+     * Given a threshold (see SHORT_CIRCUIT_SCORING), candidates scored one
+     * at a time evaluate the residuals in order of the width of their
+     * weighted bounds (see bounds) per measured cost, and are abandoned as
+     * soon as the robustness of the properties evaluated so far, plus the
+     * most the others can add, cannot exceed the threshold.
+     */
+    class ActionScorer {
+
+        // Buffers of one worker
+        struct Workspace {
+            std::unique_ptr<Signal> estSignal; // committed signal + one estimated tick (on first use)
+            StateBatch batch;                  // estimated states of the candidates
+            std::vector<float> north, east, down; // commanded velocities of the batch
+            std::vector<float> pursuit;        // the enemy's, see predictStates
+            std::vector<float> robustness;     // of one residual for the batch
+            // Short-circuited scoring
+            std::vector<float> values;         // robustness of each property of a candidate
+            std::vector<double> cost;          // time spent evaluating each residual (ns)
+            std::vector<unsigned long> samples; // evaluations it was measured over
+            unsigned long evaluated = 0, pruned = 0; // residual evaluations done (on any path) and skipped
+        };
+
+        std::vector<StlExpr*> residuals;
+        std::vector<float> weights;
+        std::vector<float> maxContribution; // most each residual can add to a score (may be infinite)
+        std::vector<float> range;           // width of what each residual can add
+        bool bounded = false;               // whether the two above hold for the actions within:
+        dronecode_sdk::Offboard::VelocityNEDYaw boundedLower, boundedUpper;
+        std::vector<float> gain;            // range of each residual per measured cost (ns)
+        std::vector<int> order;             // of evaluation of the residuals, when short-circuiting
+        std::vector<float> remaining;       // most the residuals from each position of "order" on can add
+        Signal* signal;      // committed signal (up to tick t)
+        int t;               // current tick
+        const DroneModel& model;
+        float current[StateBatch::NUM_CHANNELS]; // latest committed state
+        bool batchable;
+        ThreadPool* pool;
+        std::vector<Workspace> workspaces; // one per worker
+
+        // (also writes the robustness of each property to "values", if not null)
+        float score(const dronecode_sdk::Offboard::VelocityNEDYaw& action, Workspace& ws, float* values);
+        // Scores actions [first, last) into "scores" (and their rows of "values", if not null)
+        void scoreRange(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                        int first, int last, float* scores, float* values, Workspace& ws);
+        // Same as score(action, ws, nullptr), abandoning the action if it cannot score above "threshold"
+        float scorePruned(const dronecode_sdk::Offboard::VelocityNEDYaw& action, Workspace& ws, float threshold);
+        // (short-circuits with a finite "threshold")
+        void scoreAll(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                      float* scores, float* values, float threshold);
+        // Bounds what each residual can add to the scores of "actions", and orders
+        // the residuals by the width of that range per measured cost
+        void reorder(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions);
+
+    public:
+        // Actions per parallel task; fewer actions are scored serially
+        static const int PARALLEL_CHUNK = 16;
+
+        ActionScorer(const std::vector<StlExpr*>& properties,
+                     const std::vector<float>& weights,
+                     Signal* signal, int t, const DroneModel& model, ThreadPool* pool = nullptr);
+        ~ActionScorer();
+        ActionScorer(const ActionScorer&) = delete;
+        ActionScorer& operator=(const ActionScorer&) = delete;
+
+        // Returns the weighted robustness of performing "action"
+        float score(const dronecode_sdk::Offboard::VelocityNEDYaw& action);
+        // Writes the weighted robustness of performing each of the actions to "scores"
+        void score(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                   std::vector<float>& scores);
+        // Same, also writing the (unweighted) robustness of each property to "values":
+        // a row per action, one value per property (in the order of the properties)
+        void score(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                   std::vector<float>& scores, std::vector<float>& values);
+        // Same as score(actions, scores), but an action scored on its own (not in a batch)
+        // may be abandoned once it cannot score above "threshold" (if SHORT_CIRCUIT_SCORING):
+        // its score is then an upper bound below "threshold". Every other score is exactly
+        // as without a threshold.
+        void score(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                   std::vector<float>& scores, float threshold);
+        // Residual evaluations done so far (however the actions were scored), and those
+        // skipped by short-circuited scoring: together, the actions scored times the properties
+        unsigned long evaluations() const;
+        unsigned long prunedEvaluations() const;
+        // Number of properties (values per action)
+        int numProperties() const { return residuals.size(); };
+        // Bounds the weighted robustness of every action within the box [lower, upper]
+        // (per axis) by "lo" and "hi" (up to rounding), from the bounds on the
+        // predicted states (see predictBounds). Returns false if some residual
+        // property cannot be bounded (see StlExpr::robustnessBounds).
+        bool bounds(const dronecode_sdk::Offboard::VelocityNEDYaw& lower,
+                    const dronecode_sdk::Offboard::VelocityNEDYaw& upper, float& lo, float& hi);
+        // Restricts "region" to the actions after which every residual
+        // property is satisfied (see StlExpr::feasibleActions).
+        // Returns false if some property cannot describe its region.
+        bool feasibleRegion(ActionRegion& region);
+    };
+
+    /**
+     * Scores sequences of actions, each held for one prediction step of
+     * TICKS_TO_CORRECT ticks, by the weighted sum of the robustness of each
+     * property over the predicted trajectory, i.e., its minimum over the
+     * steps (as an "always" over the horizon would).
+     *
+     * As ActionScorer, it folds the committed signal into the properties
+     * once (a residual per step), and rolls batches of sequences out step
+     * by step when every residual only reads its own tick; given a thread
+     * pool, chunks of sequences are scored in parallel.
+     */
+    class SequenceScorer {
+
+        // Buffers of one worker
+        struct Workspace {
+            std::unique_ptr<Signal> estSignal; // committed signal + the estimated steps (on first use)
+            StateBatch batch;                  // estimated states of the sequences at one step
+            std::vector<float> north, east, down; // commanded velocities of the batch at one step
+            std::vector<float> pursuit;        // the enemy's, see predictStates
+            std::vector<float> states;         // estimated states, as rows (signal path)
+            std::vector<float> robustness;     // of one residual for the batch
+            std::vector<float> minimum;        // of each property over the steps, per sequence
+        };
+
+        std::vector<std::vector<StlExpr*>> residuals; // per step, per property
+        std::vector<float> weights;
+        Signal* signal;      // committed signal (up to tick t)
+        int t;               // current tick
+        int steps;
+        const DroneModel& model;
+        float current[StateBatch::NUM_CHANNELS]; // latest committed state
+        bool batchable;
+        ThreadPool* pool;
+        std::vector<Workspace> workspaces; // one per worker
+
+        // Scores sequences [first, last) into "scores"
+        void scoreRange(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& sequences,
+                        int first, int last, float* scores, Workspace& ws);
+
+    public:
+        // Sequences per parallel task
+        static const int PARALLEL_CHUNK = 8;
+
+        SequenceScorer(const std::vector<StlExpr*>& properties,
+                       const std::vector<float>& weights,
+                       Signal* signal, int t, int steps, const DroneModel& model,
+                       ThreadPool* pool = nullptr);
+        ~SequenceScorer();
+        SequenceScorer(const SequenceScorer&) = delete;
+        SequenceScorer& operator=(const SequenceScorer&) = delete;
+
+        int horizon() const { return steps; };
+        // Writes the weighted robustness of each sequence to "scores"; "sequences"
+        // holds horizon() actions per sequence, one sequence after the other
+        void score(const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& sequences,
+                   std::vector<float>& scores);
+    };
+
+    /**
+     * Estimates the state (one row of the StateStore signal) after performing
+     * "action" for TICKS_TO_CORRECT ticks from the latest state of "signal":
+     * the drone moves as "model" predicts, and the enemy chases it. With
+     * JOINT_ROLLOUT, both drones are advanced together a tick at a time,
+     * the enemy following the pursuit law of the follower (run_follower)
+     * with the same model.
+     */
+    void predictState(const DroneModel& model, Signal* signal,
+                      const dronecode_sdk::Offboard::VelocityNEDYaw& action, float* state);
+    // Same, from the state "current" (a row of the StateStore signal)
+    void predictState(const DroneModel& model, const float* current,
+                      const dronecode_sdk::Offboard::VelocityNEDYaw& action, float* state);
+    // The state a single tick after "current", both drones advanced together
+    // as with JOINT_ROLLOUT (whatever its setting)
+    void predictNextTick(const DroneModel& model, const float* current,
+                         const dronecode_sdk::Offboard::VelocityNEDYaw& action, float* state);
+    // Same, in place for every state of "states", the i-th performing the
+    // commanded velocity ("north", "east", "down") of index i; "pursuit"
+    // holds the enemy's commands (resized as needed)
+    void predictStates(const DroneModel& model, StateBatch& states,
+                       const float* north, const float* east, const float* down,
+                       std::vector<float>& pursuit);
+    // Bounds the states predicted from "current" for every action within the box
+    // [lower, upper] (per axis), as the model is monotone (see DroneModel): the
+    // drone's channels are bounded by the predictions at the box's corners, and,
+    // with JOINT_ROLLOUT, the enemy's by those of the range of its pursuit
+    // commands, tick by tick. Without JOINT_ROLLOUT the enemy's velocity is
+    // left unbounded.
+    void predictBounds(const DroneModel& model, const float* current,
+                       const dronecode_sdk::Offboard::VelocityNEDYaw& lower,
+                       const dronecode_sdk::Offboard::VelocityNEDYaw& upper,
+                       StateBounds& bounds);
+
+}
+
+#endif //MISSIONAPP_ACTIONSCORER_H
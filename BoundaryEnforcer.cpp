@@ -36,13 +36,22 @@ namespace cdra {
 				       std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
 				       std::shared_ptr<StateStore> store) : StlEnforcer(offboard, telemetry, store) {
         enforcerName = "Boundary Enforcer";
-        ttiFun = new TTIFun(lowerx, upperx, lowery, uppery, lowerz, upperz, safeThreshold);
-        prop = new Prop(ttiFun);
+        if (!droneutil::GEOFENCE_FILE.empty()) {
+            Geofence fence;
+            if (!fence.load(droneutil::GEOFENCE_FILE))
+                throw "Geofence unavailable!";
+            geofenceFun = new GeofenceFun(fence, safeThreshold);
+            prop = new Prop(geofenceFun);
+        } else {
+            ttiFun = new TTIFun(lowerx, upperx, lowery, uppery, lowerz, upperz, safeThreshold);
+            prop = new Prop(ttiFun);
+        }
 	//prop = new PastGlobal(new Prop(ttiFun), droneutil::TICKS_TO_CORRECT, 0);
     }
 
     BoundaryEnforcer::~BoundaryEnforcer(){
         delete ttiFun;
+        delete geofenceFun;
     }
 
     std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
@@ -73,6 +82,12 @@ namespace cdra {
         //cout << "Signal length: " << signal->length() << endl;
         //cout << "TTI: " << ttiFun->value(signal) + safeThreshold << endl;
 
+        std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> newNEDs;
+        if (geofenceFun) {
+            enumerateGeofenceVelNEDs(velocity_ned_yaw, newNEDs);
+            return newNEDs;
+        }
+
         // pre-compute go to origin msg
 	
         float diag;
@@ -104,7 +119,6 @@ namespace cdra {
 
 
         // generate new enforcement commands
-        std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> newNEDs;
 
         
 	if(droneutil::SUGGEST_ACTION_RANGE) {
@@ -224,6 +238,47 @@ namespace cdra {
         }
     }
 
+    void BoundaryEnforcer::enumerateGeofenceVelNEDs(Offboard::VelocityNEDYaw velNED, std::vector<Offboard::VelocityNEDYaw> &newNEDs){
+        Signal* sig = store->getSignal();
+        const float pos_north_m = sig->value("pos_north_m");
+        const float pos_east_m  = sig->value("pos_east_m");
+        const float pos_up_m    = -sig->value("pos_down_m");
+        const float vel_up      = -sig->value("vel_down_m_s");
+        const float yaw = velNED.yaw_deg;
+        const Geofence& fence = geofenceFun->getGeofence();
+
+        // Head away from the closest wall (back inside if outside of the geofence)
+        Geofence::Point in = fence.inwardDirection(pos_north_m, pos_east_m);
+
+        // and back towards the middle altitude if close to the floor or ceiling
+        float to_middle_down = 0;
+        if (geofenceFun->closeToZBoundary(pos_up_m, vel_up)) {
+            float middle = (fence.floorAltitude() + fence.ceilingAltitude()) / 2;
+            to_middle_down = pos_up_m > middle ? 1 : -1;
+        }
+
+        Offboard::VelocityNEDYaw inward = makeNED(in.north, in.east, to_middle_down, yaw);
+        if (droneutil::getMagnitude(inward) == 0) {
+            // On a wall, or no walls at all: keep the commanded velocity
+            newNEDs.push_back(velNED);
+            return;
+        }
+
+        // A fan of directions around the inward one (if suggesting a range), the inward one last
+        const float PI = 3.14159265f;
+        for (int deg = -60; droneutil::SUGGEST_ACTION_RANGE && deg <= 60; deg += 30) {
+            if (deg == 0)
+                continue;
+            float c = cos(deg * PI / 180), s = sin(deg * PI / 180);
+            Offboard::VelocityNEDYaw v = makeNED(c * in.north - s * in.east, s * in.north + c * in.east,
+                                                 to_middle_down, yaw);
+            droneutil::scaleToMaxVelocity(v);
+            newNEDs.push_back(v);
+        }
+        droneutil::scaleToMaxVelocity(inward);
+        newNEDs.push_back(inward);
+    }
+
     void BoundaryEnforcer::weightedMergeCommands(dronecode_sdk::Offboard::VelocityNEDYaw& msg,
         const dronecode_sdk::Offboard::VelocityNEDYaw& other, float weight) {
         msg.north_m_s = weight * msg.north_m_s + (1 - weight) * other.north_m_s;
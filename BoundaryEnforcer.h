@@ -27,13 +27,16 @@
 
 #include "StlEnforcer.h"
 #include "TTIFun.h"
+#include "GeofenceFun.h"
 
 namespace cdra {
 
     class BoundaryEnforcer : public StlEnforcer {
 
         //const int MAX_UNSAFE_PERIOD=4;
-        TTIFun* ttiFun;
+        TTIFun* ttiFun = nullptr;
+        // Used instead of the box if droneutil::GEOFENCE_FILE is set
+        GeofenceFun* geofenceFun = nullptr;
         //-- the cube boundaries are specified as lower and upper bounds
         //-- on X, Y and Z
         //-- In NED x -> north, y -> east, z -> down
@@ -49,6 +52,8 @@ namespace cdra {
 
         void enumerateSafeVelNEDs(dronecode_sdk::Offboard::VelocityNEDYaw velNED,
                 std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> &newNEDs);
+        void enumerateGeofenceVelNEDs(dronecode_sdk::Offboard::VelocityNEDYaw velNED,
+                std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> &newNEDs);
         dronecode_sdk::Offboard::VelocityNEDYaw makeNED(float north_m_s, float east_m_s, float down_m_s, float yaw_deg);
 
 
@@ -0,0 +1,111 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "CandidateGenerator.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace cdra {
+
+  std::unique_ptr<CandidateGenerator> CandidateGenerator::create(int kind, unsigned int seed) {
+    if (kind == HALTON) {
+      return std::unique_ptr<CandidateGenerator>(new HaltonGenerator(seed));
+    }
+    return std::unique_ptr<CandidateGenerator>(new RandomGenerator(seed));
+  }
+
+  /* Inverse of the standard normal CDF (Acklam's rational approximation,
+   * relative error 1.2e-9) */
+  static double normalQuantile(double p) {
+    static const double a[] = {-3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+			       1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+			       6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+			       -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[] = { 7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+			       3.754408661907416e+00};
+    const double low = 0.02425;
+    if (p < low) {
+      double q = sqrt(-2*log(p));
+      return (((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+    }
+    if (p > 1 - low) {
+      double q = sqrt(-2*log(1-p));
+      return -(((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+    }
+    double q = p - 0.5, r = q*q;
+    return (((((a[0]*r+a[1])*r+a[2])*r+a[3])*r+a[4])*r+a[5])*q / (((((b[0]*r+b[1])*r+b[2])*r+b[3])*r+b[4])*r+1);
+  }
+
+  void CandidateGenerator::nextNormal(float z[3]) {
+    float u[3];
+    next(u);
+    for (int d = 0; d < 3; d++) {
+      // Keep away from 0 (the points are in [0, 1))
+      z[d] = normalQuantile(std::max((double)u[d], 1e-7));
+    }
+  }
+
+  RandomGenerator::RandomGenerator(unsigned int seed) : gen(seed), dis(0, 1) {
+  }
+
+  void RandomGenerator::next(float u[3]) {
+    for (int d = 0; d < 3; d++) {
+      u[d] = dis(gen);
+    }
+  }
+
+  static const int BASES[3] = {2, 3, 5};
+
+  HaltonGenerator::HaltonGenerator(unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dis(0, 1);
+    for (int d = 0; d < DIMENSIONS; d++) {
+      perms[d].resize(BASES[d]);
+      for (int i = 0; i < BASES[d]; i++) {
+	perms[d][i] = i;
+      }
+      std::shuffle(perms[d].begin() + 1, perms[d].end(), gen);
+      shift[d] = dis(gen);
+    }
+  }
+
+  void HaltonGenerator::next(float u[3]) {
+    for (int d = 0; d < DIMENSIONS; d++) {
+      // Scrambled radical inverse of the index
+      int base = BASES[d];
+      double inv = 1.0 / base, f = inv, r = 0;
+      for (unsigned long long i = index; i > 0; i /= base) {
+	r += perms[d][i % base] * f;
+	f *= inv;
+      }
+      r += shift[d];
+      u[d] = std::min((float)(r - floor(r)), 0.99999994f);
+    }
+    index++;
+  }
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_CANDIDATEGENERATOR_H
+#define MISSIONAPP_CANDIDATEGENERATOR_H
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * Source of the points used to synthesize candidate actions.
+   * A generator produces a sequence of points of the unit cube [0, 1)^3,
+   * which the synthesis maps onto the range of the conflicting actions.
+   * Every generator is deterministic given its seed (SEARCH_SEED).
+   */
+  class CandidateGenerator {
+  public:
+    enum Kind {
+      RANDOM = 0, // independent uniform points (mt19937)
+      HALTON = 1  // scrambled Halton sequence (low discrepancy)
+    };
+
+    virtual ~CandidateGenerator() {};
+    // Next point of the sequence
+    virtual void next(float u[3]) = 0;
+    // Next point of the sequence mapped to independent standard normal
+    // coordinates (by the inverse normal CDF, which keeps the spacing of
+    // low-discrepancy sequences)
+    void nextNormal(float z[3]);
+
+    // Generator of the given kind (see CANDIDATE_GENERATOR)
+    static std::unique_ptr<CandidateGenerator> create(int kind, unsigned int seed);
+  };
+
+  class RandomGenerator : public CandidateGenerator {
+    std::mt19937 gen;
+    std::uniform_real_distribution<float> dis;
+
+  public:
+    RandomGenerator(unsigned int seed);
+    void next(float u[3]);
+  };
+
+  /**
+   * Halton sequence in bases 2, 3 and 5 with random digit permutations
+   * (0 fixed, so the trailing zero digits stay 0) and a random toroidal
+   * shift, both drawn from the seed. Consecutive points fill the cube
+   * evenly, so a few of them cover the range of the conflicting actions
+   * as well as many more independent random points.
+   */
+  class HaltonGenerator : public CandidateGenerator {
+    static const int DIMENSIONS = 3;
+    unsigned long long index = 1; // the 0th point is the origin
+    std::vector<int> perms[DIMENSIONS];
+    float shift[DIMENSIONS];
+
+  public:
+    HaltonGenerator(unsigned int seed);
+    void next(float u[3]);
+  };
+
+}
+
+#endif //MISSIONAPP_CANDIDATEGENERATOR_H
@@ -24,6 +24,7 @@
 
 #include "Coordinator.h"
 #include "DroneUtil.h"
+#include <chrono>
 
 namespace cdra {
 
@@ -47,6 +48,7 @@ namespace cdra {
   }
   
   void Coordinator::sendVelocityNed(const dronecode_sdk::Offboard::VelocityNEDYaw &velocity_ned_yaw) {
+    auto start_time = std::chrono::steady_clock::now();
 
     // Zero out z-velocity if desired
     if(!droneutil::EGO_Z_VELOCITY) {
@@ -56,5 +58,10 @@ namespace cdra {
     }
     // Base coordinator does not do anything; simply forwards the velocity command to offboard
     offboard->send_velocity_ned(velocity_ned_yaw);
+
+    // Leave time to send the action in the next tick's deadline
+    if(store) {
+      store->recordActOverhead(std::chrono::steady_clock::now() - start_time);
+    }
   }
 }
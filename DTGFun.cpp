@@ -24,6 +24,7 @@
 
 #include "Signal.h"
 #include "DTGFun.h"
+#include "SigKernels.h"
 #include "DroneUtil.h"
 #include <cmath>
 #include <iostream>
@@ -61,6 +62,28 @@ namespace cdra {
     return value(sig, sig->length() - 1);
   }
 
+  void DTGFun::valueBatch(const StateBatch& states, float* out) {
+    int n = states.size();
+    kernels::dtg(states.data(StateBatch::POS_DOWN), n, ground_z, out);
+    for (int i = 0; i < n; i++) {
+      out[i] -= safeDist;
+    }
+    normalizeBatch(out, n);
+  }
+
+  bool DTGFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+    lower = normalizeValue(computeDTG(-bounds.upper[StateBatch::POS_DOWN]) - safeDist);
+    upper = normalizeValue(computeDTG(-bounds.lower[StateBatch::POS_DOWN]) - safeDist);
+    return true;
+  }
+
+  bool DTGFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+    // -(pos_down + vel_down*horizon) - ground_z >= safeDist
+    float pos_down_m = sig->value("pos_down_m", t);
+    region.addHalfSpace(0, 0, horizon, -pos_down_m - ground_z - safeDist);
+    return true;
+  }
+
   float DTGFun::computeDTG(float ego_z) {
     const float delta = ego_z - ground_z;
     return delta;
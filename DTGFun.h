@@ -53,6 +53,12 @@ namespace cdra {
         bool prop(Signal *sig, int t);
         // returns true iff DTG at tick "t" within safe threshold
         bool prop(Signal *sig);
+        // returns the DTG for each state of the batch
+        void valueBatch(const StateBatch& states, float* out);
+        // returns the bound on the descent rate that keeps the DTG above the safe distance
+        bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+        // bounds the DTG by the lowest and highest altitudes within "bounds"
+        bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
         std::string propStr() { return "dist-to-ground - " + std::to_string(safeDist) +  " >= 0"; };
 	std::string enforcer_name() { return "Flight";};
     };
@@ -24,7 +24,9 @@
 
 #include "Signal.h"
 #include "DTTFun.h"
+#include "SigKernels.h"
 #include "DroneUtil.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -65,6 +67,56 @@ namespace cdra {
         return value(sig, sig->length() - 1);
     }
 
+    void DTTFun::valueBatch(const StateBatch& states, float* out) {
+        int n = states.size();
+        kernels::dtt(states.data(StateBatch::POS_EAST), states.data(StateBatch::POS_NORTH),
+                     states.data(StateBatch::POS_DOWN), states.data(StateBatch::ENEMY_POS_EAST),
+                     states.data(StateBatch::ENEMY_POS_NORTH), states.data(StateBatch::ENEMY_POS_DOWN),
+                     n, out);
+        for (int i = 0; i < n; i++) {
+            out[i] -= safeDist;
+        }
+        normalizeBatch(out, n);
+    }
+
+    bool DTTFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+        const StateBatch::Channel ego[3] = { StateBatch::POS_NORTH, StateBatch::POS_EAST, StateBatch::POS_DOWN };
+        const StateBatch::Channel enemy[3] = { StateBatch::ENEMY_POS_NORTH, StateBatch::ENEMY_POS_EAST,
+                                               StateBatch::ENEMY_POS_DOWN };
+        float nearest = 0, farthest = 0;
+        for (int k = 0; k < 3; k++) {
+            // Range of the difference along the axis
+            float lo = bounds.lower[ego[k]] - bounds.upper[enemy[k]];
+            float hi = bounds.upper[ego[k]] - bounds.lower[enemy[k]];
+            float near = lo > 0 ? lo : (hi < 0 ? -hi : 0);
+            float far = std::max(fabsf(lo), fabsf(hi));
+            nearest  += near*near;
+            farthest += far*far;
+        }
+        lower = normalizeValue(sqrt(nearest) - safeDist);
+        upper = normalizeValue(sqrt(farthest) - safeDist);
+        return true;
+    }
+
+    bool DTTFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+        float d[3] = {
+            sig->value("pos_north_m", t) - (sig->value("enemy_pos_north_m", t) + sig->value("enemy_vel_north_m_s", t)*horizon),
+            sig->value("pos_east_m" , t) - (sig->value("enemy_pos_east_m" , t) + sig->value("enemy_vel_east_m_s" , t)*horizon),
+            sig->value("pos_down_m" , t) - (sig->value("enemy_pos_down_m" , t) + sig->value("enemy_vel_down_m_s" , t)*horizon)
+        };
+        float dist = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+        if (dist == 0) {
+            // No direction away from the enemy to describe the region by
+            return false;
+        }
+        // The set of safe positions (outside a ball of radius safeDist around the
+        // enemy) is not convex; keep to the half-space beyond the ball's tangent
+        // plane facing the drone: (d + v*horizon) . u >= safeDist, u = d / |d|
+        region.addHalfSpace(-d[0]/dist*horizon, -d[1]/dist*horizon, -d[2]/dist*horizon,
+                            dist - safeDist);
+        return true;
+    }
+
     float DTTFun::computeDTT(float x1, float y1, float z1, float x2, float y2, float z2) const
     {
         const float delta = sqrt(pow(x2-x1, 2.0) + pow(y2-y1, 2.0) + pow(z2-z1, 2.0));
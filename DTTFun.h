@@ -51,6 +51,12 @@ namespace cdra {
         bool prop(Signal *sig, int t);
         // returns true iff DTT at tick "t" within safe threshold
         bool prop(Signal *sig);
+        // returns the DTT for each state of the batch
+        void valueBatch(const StateBatch& states, float* out);
+        // returns the half-space of velocities that keep clear of the enemy (inner approximation)
+        bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+        // bounds the DTT by the nearest and farthest points of the position boxes
+        bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
         std::string propStr() { return "dist-to-target - " + std::to_string(safeDist) +  " >= 0"; };
 	std::string enforcer_name() { return "Runaway";};
     };
@@ -0,0 +1,105 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include <math.h>
+
+#include "DecisionCache.h"
+
+namespace cdra {
+
+  bool DecisionCache::Key::operator==(const Key& other) const {
+    for(int c = 0; c < 9; c++) {
+      if(cells[c] != other.cells[c]) {
+	return false;
+      }
+    }
+    return properties == other.properties;
+  }
+
+  size_t DecisionCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = 0;
+    auto mix = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+    for(int c = 0; c < 9; c++) {
+      mix(std::hash<int>()(key.cells[c]));
+    }
+    for(auto property : key.properties) {
+      mix(std::hash<StlExpr*>()(property));
+    }
+    return hash;
+  }
+
+  DecisionCache::DecisionCache(unsigned int capacity, float positionStep, float velocityStep)
+    : capacity(capacity), positionStep(positionStep), velocityStep(velocityStep) {}
+
+  DecisionCache::Key DecisionCache::key(Signal* signal, const std::vector<StlExpr*>& properties) const {
+    float pos[3] = { signal->value("pos_north_m"), signal->value("pos_east_m"), signal->value("pos_down_m") };
+    float vel[3] = { signal->value("vel_north_m_s"), signal->value("vel_east_m_s"), signal->value("vel_down_m_s") };
+    float enemy[3] = { signal->value("enemy_pos_north_m"), signal->value("enemy_pos_east_m"),
+		       signal->value("enemy_pos_down_m") };
+    Key key;
+    for(int k = 0; k < 3; k++) {
+      key.cells[k]     = (int)floorf(pos[k] / positionStep);
+      key.cells[3 + k] = (int)floorf(vel[k] / velocityStep);
+      key.cells[6 + k] = (int)floorf((enemy[k] - pos[k]) / positionStep);
+    }
+    key.properties = properties;
+    return key;
+  }
+
+  const DecisionCache::Entry* DecisionCache::find(const Key& key) {
+    auto found = index.find(key);
+    if(found == index.end()) {
+      return nullptr;
+    }
+    entries.splice(entries.begin(), entries, found->second);
+    return &found->second->second;
+  }
+
+  void DecisionCache::insert(const Key& key, const Entry& entry) {
+    auto found = index.find(key);
+    if(found != index.end()) {
+      found->second->second = entry;
+      entries.splice(entries.begin(), entries, found->second);
+      return;
+    }
+    if(capacity == 0) {
+      return;
+    }
+    if(entries.size() >= capacity) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+    entries.emplace_front(key, entry);
+    index[key] = entries.begin();
+  }
+
+  void DecisionCache::erase(const Key& key) {
+    auto found = index.find(key);
+    if(found != index.end()) {
+      entries.erase(found->second);
+      index.erase(found);
+    }
+  }
+
+}
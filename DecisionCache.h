@@ -0,0 +1,87 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_DECISIONCACHE_H
+#define MISSIONAPP_DECISIONCACHE_H
+
+#include <dronecode_sdk/offboard.h>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "Signal.h"
+#include "StlExpr.h"
+
+namespace cdra {
+
+  /**
+   * Decisions of past conflicts, keyed by a quantized situation: the ego
+   * drone's position and velocity and the enemy's offset from it (each
+   * rounded down to a cell of "positionStep" m or "velocityStep" m/s) and
+   * the set of active properties. A repeated conflict (e.g., meeting the
+   * same boundary corner with the enemy behind) finds the action
+   * synthesized the last time its situation's cell was seen.
+   * Holds at most "capacity" decisions, evicting the least recently used.
+   */
+  class DecisionCache {
+  public:
+    struct Key {
+      int cells[9];                      // ego position, ego velocity, enemy offset
+      std::vector<StlExpr*> properties;  // active properties, in enforcer order
+      bool operator==(const Key& other) const;
+    };
+
+    struct Entry {
+      dronecode_sdk::Offboard::VelocityNEDYaw action;
+      float robustness;   // weighted, of the action when it was synthesized
+      float synthesisMs;  // time it took to synthesize
+    };
+
+  private:
+    struct KeyHash {
+      size_t operator()(const Key& key) const;
+    };
+
+    unsigned int capacity;
+    float positionStep, velocityStep;
+    // Most recently used first
+    std::list<std::pair<Key, Entry>> entries;
+    std::unordered_map<Key, std::list<std::pair<Key, Entry>>::iterator, KeyHash> index;
+
+  public:
+    DecisionCache(unsigned int capacity, float positionStep, float velocityStep);
+
+    // Key of the latest state of "signal" with the given active properties
+    Key key(Signal* signal, const std::vector<StlExpr*>& properties) const;
+    // The decision of the key's situation (marked as recently used), or null if none
+    const Entry* find(const Key& key);
+    // Records (or replaces) the decision of the key's situation
+    void insert(const Key& key, const Entry& entry);
+    // Forgets the decision of the key's situation
+    void erase(const Key& key);
+    unsigned int size() const { return entries.size(); };
+  };
+
+}
+
+#endif //MISSIONAPP_DECISIONCACHE_H
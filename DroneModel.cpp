@@ -0,0 +1,112 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+
+#include <algorithm>
+#include <math.h>
+
+#include "DroneModel.h"
+#include "DroneUtil.h"
+
+namespace cdra {
+
+  std::unique_ptr<DroneModel> DroneModel::create(int kind) {
+    if (kind == VELOCITY_LAG) {
+      return std::unique_ptr<DroneModel>(new VelocityLagModel(droneutil::VELOCITY_LAG));
+    }
+    return std::unique_ptr<DroneModel>(new PointMassModel(droneutil::MAX_DRONE_ACCEL));
+  }
+
+  /* Channel "c" (of the ego drone) of "drone" */
+  static StateBatch::Channel channel(DroneModel::Drone drone, StateBatch::Channel c) {
+    return (StateBatch::Channel)(drone + c);
+  }
+
+  PointMassModel::PointMassModel(float maxAccel) : maxAccel(maxAccel) {}
+
+  /* One axis of "n" states: the velocity moves toward the command by at
+   * most "dv", then the position advances by the new velocity for "ticks" */
+  static void pointMassAxis(float* pos, float* vel, const float* cmd, int n, float dv, float td, float ticks) {
+    for (int i = 0; i < n; i++) {
+      float v = std::min(std::max(cmd[i], vel[i] - dv), vel[i] + dv);
+      vel[i] = v;
+      pos[i] += v * td * ticks;
+    }
+  }
+
+  void PointMassModel::step(StateBatch& states, const float* north, const float* east, const float* down,
+			    float ticks, Drone drone) const {
+    float td = droneutil::TICK_DURATION;
+    float dv = maxAccel * td * ticks;
+    int n = states.size();
+    pointMassAxis(states.data(channel(drone, StateBatch::POS_NORTH)), states.data(channel(drone, StateBatch::VEL_NORTH)), north, n, dv, td, ticks);
+    pointMassAxis(states.data(channel(drone, StateBatch::POS_EAST)),  states.data(channel(drone, StateBatch::VEL_EAST)),  east,  n, dv, td, ticks);
+    pointMassAxis(states.data(channel(drone, StateBatch::POS_DOWN)),  states.data(channel(drone, StateBatch::VEL_DOWN)),  down,  n, dv, td, ticks);
+  }
+
+  void PointMassModel::step(float* state, const dronecode_sdk::Offboard::VelocityNEDYaw& command,
+			    float ticks, Drone drone) const {
+    float td = droneutil::TICK_DURATION;
+    float dv = maxAccel * td * ticks;
+    pointMassAxis(state + drone + StateBatch::POS_NORTH, state + drone + StateBatch::VEL_NORTH, &command.north_m_s, 1, dv, td, ticks);
+    pointMassAxis(state + drone + StateBatch::POS_EAST,  state + drone + StateBatch::VEL_EAST,  &command.east_m_s,  1, dv, td, ticks);
+    pointMassAxis(state + drone + StateBatch::POS_DOWN,  state + drone + StateBatch::VEL_DOWN,  &command.down_m_s,  1, dv, td, ticks);
+  }
+
+  VelocityLagModel::VelocityLagModel(float lag) : lag(lag) {}
+
+  /* One axis of "n" states: after "dt", the velocity error decays to
+   * "decay" times its value and the position gains the integral
+   * c dt + (v - c) "gain" (gain = lag (1 - decay)) */
+  static void velocityLagAxis(float* pos, float* vel, const float* cmd, int n, float decay, float gain, float dt) {
+    for (int i = 0; i < n; i++) {
+      float error = vel[i] - cmd[i];
+      pos[i] += cmd[i] * dt + error * gain;
+      vel[i] = cmd[i] + error * decay;
+    }
+  }
+
+  void VelocityLagModel::step(StateBatch& states, const float* north, const float* east, const float* down,
+			      float ticks, Drone drone) const {
+    float dt = droneutil::TICK_DURATION * ticks;
+    // (no lag: the command is reached immediately)
+    float decay = lag > 0 ? exp(-dt / lag) : 0;
+    float gain = lag > 0 ? lag * (1 - decay) : 0;
+    int n = states.size();
+    velocityLagAxis(states.data(channel(drone, StateBatch::POS_NORTH)), states.data(channel(drone, StateBatch::VEL_NORTH)), north, n, decay, gain, dt);
+    velocityLagAxis(states.data(channel(drone, StateBatch::POS_EAST)),  states.data(channel(drone, StateBatch::VEL_EAST)),  east,  n, decay, gain, dt);
+    velocityLagAxis(states.data(channel(drone, StateBatch::POS_DOWN)),  states.data(channel(drone, StateBatch::VEL_DOWN)),  down,  n, decay, gain, dt);
+  }
+
+  void VelocityLagModel::step(float* state, const dronecode_sdk::Offboard::VelocityNEDYaw& command,
+			      float ticks, Drone drone) const {
+    float dt = droneutil::TICK_DURATION * ticks;
+    float decay = lag > 0 ? exp(-dt / lag) : 0;
+    float gain = lag > 0 ? lag * (1 - decay) : 0;
+    velocityLagAxis(state + drone + StateBatch::POS_NORTH, state + drone + StateBatch::VEL_NORTH, &command.north_m_s, 1, decay, gain, dt);
+    velocityLagAxis(state + drone + StateBatch::POS_EAST,  state + drone + StateBatch::VEL_EAST,  &command.east_m_s,  1, decay, gain, dt);
+    velocityLagAxis(state + drone + StateBatch::POS_DOWN,  state + drone + StateBatch::VEL_DOWN,  &command.down_m_s,  1, decay, gain, dt);
+  }
+
+}
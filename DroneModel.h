@@ -25,21 +25,81 @@
 #ifndef MISSIONAPP_MODEL_H
 #define MISSIONAPP_MODEL_H
 
-#include <dronecode_sdk/telemetry.h>
-#include "Signal.h"
+#include <dronecode_sdk/offboard.h>
+#include <memory>
+#include "StateBatch.h"
 
 namespace cdra {
 
     /**
-     * A model of a drone with simulated dynamics
+     * A model of the dynamics of the (ego) drone, used to predict the state
+     * after a commanded velocity is held for a number of ticks.
+     * States are advanced in batches in structure-of-arrays form (a channel
+     * per state variable, see StateBatch), so that the candidates of a tick
+     * are predicted in one pass per channel. Either drone of the state can
+     * be advanced (its POS_* and VEL_* channels).
+     * Models are monotone: along each axis, the new position and velocity
+     * do not decrease as the position, velocity or command increases, so
+     * that stepping the corners of a box of states and commands bounds the
+     * states reached from within it (see predictBounds).
      */
     class DroneModel {
 
     public:
+        enum Kind {
+            POINT_MASS   = 0, // velocity tracks the command with bounded acceleration
+            VELOCITY_LAG = 1  // velocity tracks the command as a first-order lag
+        };
+        // Drones of a state, by the offset of their channels from the ego's
+        enum Drone {
+            EGO   = 0,
+            ENEMY = StateBatch::ENEMY_POS_EAST - StateBatch::POS_EAST
+        };
+
         DroneModel() {};
         virtual ~DroneModel() {};
-        // returns the simulated next state of this drone model based on the current signal
-        virtual dronecode_sdk::Telemetry::PositionVelocityNED simulate(Signal* signal) = 0;
+        // Advances "drone" in each state of "states", in place, by holding the commanded
+        // velocity of the same index ("north", "east" and "down", m/s) for "ticks" ticks
+        virtual void step(StateBatch& states, const float* north, const float* east, const float* down,
+                          float ticks, Drone drone = EGO) const = 0;
+        // Same, for one state given as a row of StateBatch::NUM_CHANNELS values
+        virtual void step(float* state, const dronecode_sdk::Offboard::VelocityNEDYaw& command,
+                          float ticks, Drone drone = EGO) const = 0;
+
+        // Model of the given kind (see DRONE_MODEL), with its parameters from the config
+        static std::unique_ptr<DroneModel> create(int kind);
+    };
+
+    /**
+     * Point mass whose velocity moves toward the command by at most
+     * "maxAccel" (m/s^2) along each axis; the new velocity is assumed to be
+     * held over the whole step.
+     */
+    class PointMassModel : public DroneModel {
+        float maxAccel;
+
+    public:
+        PointMassModel(float maxAccel);
+        void step(StateBatch& states, const float* north, const float* east, const float* down,
+                  float ticks, Drone drone = EGO) const;
+        void step(float* state, const dronecode_sdk::Offboard::VelocityNEDYaw& command,
+                  float ticks, Drone drone = EGO) const;
+    };
+
+    /**
+     * Velocity that follows the command as a first-order lag with time
+     * constant "lag" (sec), i.e., v(s) = c + (v(0) - c) exp(-s / lag),
+     * with the position integrated exactly over the step.
+     */
+    class VelocityLagModel : public DroneModel {
+        float lag;
+
+    public:
+        VelocityLagModel(float lag);
+        void step(StateBatch& states, const float* north, const float* east, const float* down,
+                  float ticks, Drone drone = EGO) const;
+        void step(float* state, const dronecode_sdk::Offboard::VelocityNEDYaw& command,
+                  float ticks, Drone drone = EGO) const;
     };
 
 }
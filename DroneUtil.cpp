@@ -39,6 +39,10 @@ namespace droneutil {
   float ENEMY_DRONE_SPEED = 1.6;        // m/s
   float TICK_DURATION = 0.06;           // sec
   float TICKS_TO_CORRECT = 5;           // Used as the length of the prediction window in estimating signal -- Could be used to make properties violated for N ticks as well
+  int DRONE_MODEL = 0;                  // Dynamics used to predict the state after an action: 0 = point mass with bounded acceleration, 1 = first-order velocity lag (see DroneModel.h)
+  float MAX_DRONE_ACCEL = 2.0;          // m/s^2 -- per axis, only relevant to the point mass model
+  float VELOCITY_LAG = 0.3;             // sec -- time constant, only relevant to the velocity lag model
+  bool JOINT_ROLLOUT = true;            // Predict both drones together tick by tick, the enemy chasing the ego drone as the follower does (instead of a single step of the ego drone and a rough enemy estimate)
 
   // NOTE: turning off z-velocity stuff might be a bit broken right now -- not supported with all new enforcers
   bool USE_Z_VELOCITY = true;           // Should we use z velocity? (changes follower and ego z velocity)
@@ -53,13 +57,49 @@ namespace droneutil {
   float FLIGHT_WEIGHT   = 10;
   float RECON_WEIGHT    = 1;           // Unused
   float MISSILE_WEIGHT  = 3;
+  float OBSTACLE_WEIGHT = 5;           // Only used if OBSTACLE_FILE is set
 
   bool NONLINEAR_PENALTY  = true;      // Used in SigFun.cpp
+  bool FAST_NORMALIZATION = false;     // Used in SigFun.cpp -- branchless normalization with an approximate penalty curve (see SigKernels.h for its error bound)
 
   
   bool SYNTHESIZE_ACTIONS = true; // Only relevant to RobustnessCoordinator, overwritten by SynthRobustnessCoordinator (to true)
   bool CHOOSE_LEAST_DIFFERENT_ACTION = true; // Only relevant to (Synth|)RobustnessCoordinator
   unsigned int RANDOM_SEARCH_GRANULARITY = 10; // Only relevant to RobustnessCoordinator w/ synthesis -- determines how rigorously to search the action range (higher=more)
+  int CANDIDATE_GENERATOR = 1; // Only relevant to RobustnessCoordinator w/ synthesis -- points of the action range to try: 0 = uniform random, 1 = scrambled Halton sequence (see CandidateGenerator.h)
+  unsigned int SEARCH_SEED = 0; // Seed of the candidate generator (runs with the same seed try the same candidates)
+  bool SAMPLE_ON_SPHERE = true; // Only relevant to RobustnessCoordinator w/ synthesis -- sample directions on the sphere patch spanned by the conflicting actions (instead of their bounding box, projected onto the sphere)
+  int SYNTHESIS_METHOD = SYNTHESIS_SAMPLING; // Only relevant to RobustnessCoordinator w/ synthesis -- SYNTHESIS_SAMPLING (0): score samples of the action range, SYNTHESIS_CEM (1): cross-entropy method, SYNTHESIS_LP (2): sequential linear programming, SYNTHESIS_BNB (3): branch and bound on the sphere patch of the conflicting actions
+  unsigned int CEM_GENERATIONS = 4; // Only relevant to SYNTHESIS_CEM -- number of refinements of the sampling distribution
+  unsigned int CEM_POPULATION  = 32; // Only relevant to SYNTHESIS_CEM -- actions scored per generation
+  unsigned int LP_ITERATIONS   = 1;  // Only relevant to SYNTHESIS_LP -- linearize-and-solve rounds (each from the previous solution)
+  float BNB_TOLERANCE = 0.01; // Only relevant to SYNTHESIS_BNB -- regions whose robustness bound is at most this above the best action found are pruned (the result is within this of the best action)
+  unsigned int BNB_MAX_EVALUATIONS = 2048; // Only relevant to SYNTHESIS_BNB -- stop splitting regions once this many actions are scored
+  unsigned int MPC_HORIZON     = 3;  // Only relevant to MpcCoordinator -- actions (prediction steps of TICKS_TO_CORRECT ticks) per optimized sequence
+  unsigned int MPC_GENERATIONS = 4;  // Only relevant to MpcCoordinator -- refinements of the sequence distribution
+  unsigned int MPC_POPULATION  = 32; // Only relevant to MpcCoordinator -- sequences scored per generation
+  bool SYNTHESIS_DEADLINE = true; // Only relevant to RobustnessCoordinator -- stop scoring candidates at the tick deadline and use the best action found so far
+  float DEADLINE_MARGIN = 0.005;  // sec -- kept at the end of each tick for the coordinator to finish after the deadline
+  unsigned int SYNTHESIS_THREADS = 1; // Only relevant to RobustnessCoordinator -- threads scoring candidate actions (0: one per core)
+  bool TRUST_REGION = true;         // Only relevant to RobustnessCoordinator w/ synthesis -- during a sustained conflict, first search around the previous tick's action
+  float TRUST_REGION_ANGLE = 0.25;  // rad -- half-angle of the first trust region (doubled on each widening)
+  float TRUST_REGION_MARGIN = 0.1;  // widen the trust region while its best robustness is this much below the previous tick's
+  unsigned int REFINE_TOP_K = 3;    // Only relevant to RobustnessCoordinator w/ synthesis -- best sampled actions refined by projected gradient steps (0: none)
+  unsigned int REFINE_STEPS = 4;    // gradient steps per refined action
+  int PARETO_SELECTION = PARETO_OFF; // Only relevant to SYNTHESIS_SAMPLING -- instead of maximizing the weighted sum of robustness, keep each property's robustness for every candidate and choose on their Pareto front: PARETO_OFF (0), PARETO_WEIGHTED (1): highest weighted sum, PARETO_MAXIMIN (2): highest minimum robustness, PARETO_IDEAL (3): closest to the ideal point (see ParetoFront.h)
+  bool DECISION_CACHE = false; // Only relevant to RobustnessCoordinator -- reuse the action synthesized for a past conflict in the same quantized situation (ego position/velocity, enemy offset, active properties), after validating it
+  unsigned int DECISION_CACHE_SIZE = 4096; // Only relevant to DECISION_CACHE -- decisions kept (least recently used evicted)
+  float CACHE_POSITION_STEP = 1.0;  // Only relevant to DECISION_CACHE -- cell size of the ego position and enemy offset (m)
+  float CACHE_VELOCITY_STEP = 0.5;  // Only relevant to DECISION_CACHE -- cell size of the ego velocity (m/s)
+  float CACHE_TOLERANCE = 0.05;     // Only relevant to DECISION_CACHE -- a cached action is reused if its weighted robustness now is at most this below its robustness when synthesized (and no proposed action beats it)
+  std::string POLICY_TABLE_FILE = ""; // Only relevant to RobustnessCoordinator -- if set, conflicts are first looked up in this table of actions synthesized offline by policygen (see PolicyTable.h), falling back to synthesis outside it
+  bool SPECULATIVE_SYNTHESIS = false; // Only relevant to RobustnessCoordinator -- after each tick's action is sent, predict the next tick's state and synthesize its likely conflicts in the background
+  float SPECULATION_POSITION_TOLERANCE = 0.2; // Only relevant to SPECULATIVE_SYNTHESIS -- a speculated action is used if the real ego position and enemy offset are within this of the predicted ones (m, per axis)
+  float SPECULATION_VELOCITY_TOLERANCE = 0.2; // Only relevant to SPECULATIVE_SYNTHESIS -- and the real ego velocity within this of the predicted one (m/s, per axis)
+  bool BATCH_SCORING = true; // Score candidate actions in batches (signal function batch kernels) when all properties allow it
+  bool SHORT_CIRCUIT_SCORING = true; // Only relevant to RobustnessCoordinator -- stop scoring a candidate action once it cannot beat the best ones so far; no effect on batches, i.e., unless BATCH_SCORING is 0 or some property cannot be batched
+  bool SIMD_KERNELS  = true; // Use the AVX2 batch kernels if the CPU supports them (otherwise the scalar ones)
+  bool FEASIBLE_REGION_FILTER = false; // Only relevant to RobustnessCoordinator -- drop candidates outside the properties' feasible-action region and add the closest feasible actions
   
   bool SUGGEST_ACTION_RANGE = true; // Used by each enforcer -- if false, each only proposes a single action
 
@@ -73,6 +113,11 @@ namespace droneutil {
   float BOUNDARY_Z_MAX = 6;
 
   float BOUNDARY_SAFE_TTI_THRESHOLD = 1.5; // Safe TTI threshold used by BoundaryEnforcer
+  std::string GEOFENCE_FILE = "";          // Used by BoundaryEnforcer -- if set, the boundary is the geofence in this file instead of the box (see Geofence.h)
+  std::string TERRAIN_FILE  = "";          // Used by Flight/MissileEnforcer -- if set, distances to ground (and the missile elevation) are above the terrain in this heightmap instead of flat ground (see Heightmap.h)
+  std::string MISSILE_ZONE_FILE = "";      // Used by MissileEnforcer -- if set, the missile areas (each with its own elevation) are read from this file instead of the built-in area (see ZoneSet.h)
+  std::string OBSTACLE_FILE = "";          // Used by ObstacleEnforcer -- static obstacles (see KdTree.h); the enforcer is only added if set
+  float OBSTACLE_SAFE_DISTANCE = 1.0;      // Safe distance to the surface of any obstacle used by ObstacleEnforcer
   
   void scaleVector(Offboard::VelocityNEDYaw& vec, float new_magnitude) {
     float cur_magnitude  = getMagnitude(vec);
@@ -129,6 +174,14 @@ namespace droneutil {
       TICK_DURATION = value;
     } else if(name == "TICKS_TO_CORRECT") {
       TICKS_TO_CORRECT = value;
+    } else if(name == "DRONE_MODEL") {
+      DRONE_MODEL = value;
+    } else if(name == "MAX_DRONE_ACCEL") {
+      MAX_DRONE_ACCEL = value;
+    } else if(name == "VELOCITY_LAG") {
+      VELOCITY_LAG = value;
+    } else if(name == "JOINT_ROLLOUT") {
+      JOINT_ROLLOUT = value != 0;
     } else if(name == "USE_Z_VELOCITY") {
       USE_Z_VELOCITY = value != 0;
       FOLLOWER_Z_VELOCITY = USE_Z_VELOCITY;
@@ -145,6 +198,8 @@ namespace droneutil {
       MISSILE_WEIGHT = value;
     } else if(name == "RECON_WEIGHT") {
       RECON_WEIGHT = value;
+    } else if(name == "OBSTACLE_WEIGHT") {
+      OBSTACLE_WEIGHT = value;
     } else if(name == "RECON_HEIGHT") {
       RECON_HEIGHT = value;
     } else if(name == "NONLINEAR_PENALTY") {
@@ -169,6 +224,8 @@ namespace droneutil {
       BOUNDARY_Z_MIN = value;
     } else if(name == "BOUNDARY_SAFE_TTI_THRESHOLD") {
       BOUNDARY_SAFE_TTI_THRESHOLD = value;
+    } else if(name == "OBSTACLE_SAFE_DISTANCE") {
+      OBSTACLE_SAFE_DISTANCE = value;
     } else if(name == "BOUNDARY_SIZE") {
       BOUNDARY_X_MIN = -value;
       BOUNDARY_X_MAX = value;
@@ -178,21 +235,115 @@ namespace droneutil {
       BOUNDARY_Z_MAX = value;
     } else if(name == "RANDOM_SEARCH_GRANULARITY") {
       RANDOM_SEARCH_GRANULARITY = value;
+    } else if(name == "CANDIDATE_GENERATOR") {
+      CANDIDATE_GENERATOR = value;
+    } else if(name == "SEARCH_SEED") {
+      SEARCH_SEED = value;
+    } else if(name == "SAMPLE_ON_SPHERE") {
+      SAMPLE_ON_SPHERE = value != 0;
+    } else if(name == "SYNTHESIS_METHOD") {
+      SYNTHESIS_METHOD = value;
+    } else if(name == "CEM_GENERATIONS") {
+      CEM_GENERATIONS = value;
+    } else if(name == "CEM_POPULATION") {
+      CEM_POPULATION = value;
+    } else if(name == "LP_ITERATIONS") {
+      LP_ITERATIONS = value;
+    } else if(name == "BNB_TOLERANCE") {
+      BNB_TOLERANCE = value;
+    } else if(name == "BNB_MAX_EVALUATIONS") {
+      BNB_MAX_EVALUATIONS = value;
+    } else if(name == "MPC_HORIZON") {
+      MPC_HORIZON = value;
+    } else if(name == "MPC_GENERATIONS") {
+      MPC_GENERATIONS = value;
+    } else if(name == "MPC_POPULATION") {
+      MPC_POPULATION = value;
+    } else if(name == "SYNTHESIS_DEADLINE") {
+      SYNTHESIS_DEADLINE = value != 0;
+    } else if(name == "DEADLINE_MARGIN") {
+      DEADLINE_MARGIN = value;
+    } else if(name == "SYNTHESIS_THREADS") {
+      SYNTHESIS_THREADS = value;
+    } else if(name == "TRUST_REGION") {
+      TRUST_REGION = value != 0;
+    } else if(name == "TRUST_REGION_ANGLE") {
+      TRUST_REGION_ANGLE = value;
+    } else if(name == "TRUST_REGION_MARGIN") {
+      TRUST_REGION_MARGIN = value;
+    } else if(name == "REFINE_TOP_K") {
+      REFINE_TOP_K = value;
+    } else if(name == "REFINE_STEPS") {
+      REFINE_STEPS = value;
+    } else if(name == "PARETO_SELECTION") {
+      PARETO_SELECTION = value;
+    } else if(name == "FAST_NORMALIZATION") {
+      FAST_NORMALIZATION = value != 0;
+    } else if(name == "DECISION_CACHE") {
+      DECISION_CACHE = value != 0;
+    } else if(name == "DECISION_CACHE_SIZE") {
+      DECISION_CACHE_SIZE = value;
+    } else if(name == "CACHE_POSITION_STEP") {
+      CACHE_POSITION_STEP = value;
+    } else if(name == "CACHE_VELOCITY_STEP") {
+      CACHE_VELOCITY_STEP = value;
+    } else if(name == "CACHE_TOLERANCE") {
+      CACHE_TOLERANCE = value;
+    } else if(name == "SPECULATIVE_SYNTHESIS") {
+      SPECULATIVE_SYNTHESIS = value != 0;
+    } else if(name == "SPECULATION_POSITION_TOLERANCE") {
+      SPECULATION_POSITION_TOLERANCE = value;
+    } else if(name == "SPECULATION_VELOCITY_TOLERANCE") {
+      SPECULATION_VELOCITY_TOLERANCE = value;
+    } else if(name == "BATCH_SCORING") {
+      BATCH_SCORING = value != 0;
+    } else if(name == "SHORT_CIRCUIT_SCORING") {
+      SHORT_CIRCUIT_SCORING = value != 0;
+    } else if(name == "SIMD_KERNELS") {
+      SIMD_KERNELS = value != 0;
+    } else if(name == "FEASIBLE_REGION_FILTER") {
+      FEASIBLE_REGION_FILTER = value != 0;
     } else {
       fprintf(stderr, "Unknown variable name: %s, %f\n", name.c_str(), value);
     }
   }
   
+  /* Variables with string values (e.g., file names); returns false for any other name */
+  bool setStringVar(std::string name, std::string value) {
+    if(name == "GEOFENCE_FILE") {
+      GEOFENCE_FILE = value;
+    } else if(name == "TERRAIN_FILE") {
+      TERRAIN_FILE = value;
+    } else if(name == "MISSILE_ZONE_FILE") {
+      MISSILE_ZONE_FILE = value;
+    } else if(name == "OBSTACLE_FILE") {
+      OBSTACLE_FILE = value;
+    } else if(name == "POLICY_TABLE_FILE") {
+      POLICY_TABLE_FILE = value;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  
   void parseConfig(std::string fname){
     std::ifstream infile(fname);
     std::string line;
 
     while (std::getline(infile, line)) {
       std::istringstream iss(line);
-      std::string name;
+      std::string name, text;
       float val;
      
-      if (!(iss >> name >> val)) { break; } // error
+      if (!(iss >> name >> text)) { break; } // error
+
+      if (setStringVar(name, text)) {
+	std::cout << name << ":" << text << std::endl;
+	continue;
+      }
+      
+      std::istringstream vss(text);
+      if (!(vss >> val)) { break; } // error
       
       setVar(name, val);      
 
@@ -29,6 +29,7 @@
 #include <dronecode_sdk/telemetry.h>
 #include <stdbool.h>
 #include <cmath>
+#include <string>
 
 namespace droneutil {
   // See explanations in DroneUtil.cpp
@@ -37,6 +38,10 @@ namespace droneutil {
   extern float ENEMY_DRONE_SPEED;
   extern float TICK_DURATION;
   extern float TICKS_TO_CORRECT;
+  extern int DRONE_MODEL;
+  extern float MAX_DRONE_ACCEL;
+  extern float VELOCITY_LAG;
+  extern bool JOINT_ROLLOUT;
   
   extern bool USE_Z_VELOCITY; 
   extern bool FOLLOWER_Z_VELOCITY;
@@ -50,11 +55,57 @@ namespace droneutil {
   extern float FLIGHT_WEIGHT;
   extern float MISSILE_WEIGHT;
   extern float RECON_WEIGHT;
+  extern float OBSTACLE_WEIGHT;
 
   extern bool NONLINEAR_PENALTY;
+  extern bool FAST_NORMALIZATION;
   extern bool SYNTHESIZE_ACTIONS;
   extern bool CHOOSE_LEAST_DIFFERENT_ACTION;
   extern unsigned int RANDOM_SEARCH_GRANULARITY;
+  extern int CANDIDATE_GENERATOR;
+  extern unsigned int SEARCH_SEED;
+  extern bool SAMPLE_ON_SPHERE;
+  // Values of SYNTHESIS_METHOD
+  const int SYNTHESIS_SAMPLING = 0;
+  const int SYNTHESIS_CEM      = 1;
+  const int SYNTHESIS_LP       = 2;
+  const int SYNTHESIS_BNB      = 3;
+  extern int SYNTHESIS_METHOD;
+  extern unsigned int CEM_GENERATIONS;
+  extern unsigned int CEM_POPULATION;
+  extern unsigned int LP_ITERATIONS;
+  extern float BNB_TOLERANCE;
+  extern unsigned int BNB_MAX_EVALUATIONS;
+  extern unsigned int MPC_HORIZON;
+  extern unsigned int MPC_GENERATIONS;
+  extern unsigned int MPC_POPULATION;
+  extern bool SYNTHESIS_DEADLINE;
+  extern float DEADLINE_MARGIN;
+  extern unsigned int SYNTHESIS_THREADS;
+  extern bool TRUST_REGION;
+  extern float TRUST_REGION_ANGLE;
+  extern float TRUST_REGION_MARGIN;
+  extern unsigned int REFINE_TOP_K;
+  extern unsigned int REFINE_STEPS;
+  // Values of PARETO_SELECTION
+  const int PARETO_OFF      = 0;
+  const int PARETO_WEIGHTED = 1;
+  const int PARETO_MAXIMIN  = 2;
+  const int PARETO_IDEAL    = 3;
+  extern int PARETO_SELECTION;
+  extern bool DECISION_CACHE;
+  extern unsigned int DECISION_CACHE_SIZE;
+  extern float CACHE_POSITION_STEP;
+  extern float CACHE_VELOCITY_STEP;
+  extern float CACHE_TOLERANCE;
+  extern std::string POLICY_TABLE_FILE;
+  extern bool SPECULATIVE_SYNTHESIS;
+  extern float SPECULATION_POSITION_TOLERANCE;
+  extern float SPECULATION_VELOCITY_TOLERANCE;
+  extern bool BATCH_SCORING;
+  extern bool SHORT_CIRCUIT_SCORING;
+  extern bool SIMD_KERNELS;
+  extern bool FEASIBLE_REGION_FILTER;
   
   extern bool SUGGEST_ACTION_RANGE;
 
@@ -68,6 +119,11 @@ namespace droneutil {
   extern float BOUNDARY_Z_MAX;
 
   extern float BOUNDARY_SAFE_TTI_THRESHOLD;
+  extern std::string GEOFENCE_FILE;
+  extern std::string TERRAIN_FILE;
+  extern std::string MISSILE_ZONE_FILE;
+  extern std::string OBSTACLE_FILE;
+  extern float OBSTACLE_SAFE_DISTANCE;
   
   /*
   struct DroneConfig {
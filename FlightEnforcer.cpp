@@ -42,12 +42,21 @@ namespace cdra {
         enforcerName = "Flight Enforcer";
 	
         // Property: Current DTG is maintained above a safe threshold
-        dtgFun = new DTGFun(1);
-	prop   = new Prop(dtgFun);
+        if (!droneutil::TERRAIN_FILE.empty()) {
+            auto terrain = Heightmap::shared(droneutil::TERRAIN_FILE);
+            if (!terrain)
+                throw "Terrain unavailable!";
+            terrainFun = new TerrainFun(terrain, 1);
+            prop   = new Prop(terrainFun);
+        } else {
+            dtgFun = new DTGFun(1);
+            prop   = new Prop(dtgFun);
+        }
     }
 
     FlightEnforcer::~FlightEnforcer(){
         delete dtgFun;
+        delete terrainFun;
     }
 
     std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
@@ -93,6 +102,21 @@ namespace cdra {
 	    }
 	  }
 	}
+
+	if(terrainFun) {
+	  /* Climb while moving down the slope (away from rising ground) */
+	  Signal* signal = store->getSignal();
+	  float slope_north, slope_east;
+	  terrainFun->getTerrain()->gradient(signal->value("pos_north_m"), signal->value("pos_east_m"),
+					     slope_north, slope_east);
+	  if(slope_north != 0 || slope_east != 0) {
+	    Offboard::VelocityNEDYaw downhillNED { -slope_north, -slope_east, 0, velocity_ned_yaw.yaw_deg };
+	    droneutil::scaleVector(downhillNED, droneutil::MAX_DRONE_SPEED / 2);
+	    downhillNED.down_m_s = down_vel;
+	    droneutil::scaleToMaxVelocity(downhillNED);
+	    newNEDs.push_back(downhillNED);
+	  }
+	}
         newNEDs.push_back(newNED);
 
         return newNEDs;
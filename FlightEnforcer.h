@@ -27,6 +27,7 @@
 
 #include "StlEnforcer.h"
 #include "DTGFun.h"
+#include "TerrainFun.h"
 #include "StlExpr.h"
 #include "DroneUtil.h"
 
@@ -35,7 +36,9 @@ namespace cdra {
     class FlightEnforcer : public StlEnforcer {
       
       // DTG = Distance to Ground
-        DTGFun* dtgFun;
+        DTGFun* dtgFun = nullptr;
+        // Used instead of flat ground if droneutil::TERRAIN_FILE is set
+        TerrainFun* terrainFun = nullptr;
 
     protected:
         std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
@@ -0,0 +1,279 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "Geofence.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <math.h>
+#include <sstream>
+
+namespace cdra {
+
+  static const float INF = std::numeric_limits<float>::infinity();
+
+  static inline float cross(float ax, float ay, float bx, float by) {
+    return ax * by - ay * bx;
+  }
+
+  bool Geofence::load(const std::string& fname) {
+    std::ifstream infile(fname);
+    if (!infile) {
+      std::cerr << "Cannot open geofence file: " << fname << std::endl;
+      return false;
+    }
+
+    std::vector<std::vector<Point> > polygons;
+    std::string line;
+    while (std::getline(infile, line)) {
+      line = line.substr(0, line.find('#'));
+      std::istringstream iss(line);
+      std::string word;
+      if (!(iss >> word)) {
+	continue;
+      }
+      if (word == "outer" || word == "hole") {
+	polygons.push_back(std::vector<Point>());
+      } else if (word == "floor" || word == "ceiling") {
+	float z;
+	if (!(iss >> z)) {
+	  std::cerr << "Bad geofence line: " << line << std::endl;
+	  return false;
+	}
+	(word == "floor" ? floorZ : ceilingZ) = z;
+      } else {
+	Point p;
+	std::istringstream pss(line);
+	if (polygons.empty() || !(pss >> p.north >> p.east)) {
+	  std::cerr << "Bad geofence line: " << line << std::endl;
+	  return false;
+	}
+	polygons.back().push_back(p);
+      }
+    }
+
+    segments.clear();
+    for (auto& polygon : polygons) {
+      addPolygon(polygon);
+    }
+    build();
+    std::cout << "Geofence: " << polygons.size() << " polygons, " << segments.size()
+	      << " walls, altitude [" << floorZ << ", " << ceilingZ << "]" << std::endl;
+    return !segments.empty() && floorZ < ceilingZ;
+  }
+
+  void Geofence::addPolygon(const std::vector<Point>& vertices) {
+    int n = vertices.size();
+    for (int i = 0; i < n && n > 1; i++) {
+      segments.push_back({vertices[i], vertices[(i + 1) % n]});
+    }
+  }
+
+  void Geofence::build() {
+    nodes.clear();
+    if (!segments.empty()) {
+      buildNode(0, segments.size());
+    }
+  }
+
+  int Geofence::buildNode(int first, int count) {
+    Node node;
+    node.minNorth = node.minEast = INF;
+    node.maxNorth = node.maxEast = -INF;
+    for (int i = first; i < first + count; i++) {
+      const Segment& s = segments[i];
+      node.minNorth = std::min(node.minNorth, std::min(s.a.north, s.b.north));
+      node.maxNorth = std::max(node.maxNorth, std::max(s.a.north, s.b.north));
+      node.minEast  = std::min(node.minEast , std::min(s.a.east , s.b.east ));
+      node.maxEast  = std::max(node.maxEast , std::max(s.a.east , s.b.east ));
+    }
+    node.left = node.right = -1;
+    node.first = first;
+    node.count = count;
+
+    int index = nodes.size();
+    nodes.push_back(node);
+    if (count <= LEAF_SIZE) {
+      return index;
+    }
+
+    // Median split of the segment midpoints along the longer side
+    bool by_north = node.maxNorth - node.minNorth >= node.maxEast - node.minEast;
+    auto mid = segments.begin() + first + count / 2;
+    std::nth_element(segments.begin() + first, mid, segments.begin() + first + count,
+		     [by_north](const Segment& s1, const Segment& s2) {
+		       return by_north ?
+			 s1.a.north + s1.b.north < s2.a.north + s2.b.north :
+			 s1.a.east  + s1.b.east  < s2.a.east  + s2.b.east;
+		     });
+    int left  = buildNode(first, count / 2);
+    int right = buildNode(first + count / 2, count - count / 2);
+    nodes[index].left  = left;
+    nodes[index].right = right;
+    nodes[index].count = 0;
+    return index;
+  }
+
+  bool Geofence::contains(float north, float east) const {
+    // Even-odd rule: count the walls crossed by the ray towards +north
+    bool inside = false;
+    if (nodes.empty()) {
+      return false;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node& node = nodes[stack[--top]];
+      if (east < node.minEast || east > node.maxEast || node.maxNorth < north) {
+	continue;
+      }
+      if (node.count == 0) {
+	stack[top++] = node.left;
+	stack[top++] = node.right;
+	continue;
+      }
+      for (int i = node.first; i < node.first + node.count; i++) {
+	const Segment& s = segments[i];
+	if ((s.a.east > east) != (s.b.east > east)) {
+	  float n = s.a.north + (east - s.a.east) * (s.b.north - s.a.north) / (s.b.east - s.a.east);
+	  if (n > north) {
+	    inside = !inside;
+	  }
+	}
+      }
+    }
+    return inside;
+  }
+
+  float Geofence::timeToWall(float north, float east, float vel_north, float vel_east) const {
+    float best = INF;
+    if (nodes.empty() || (vel_north == 0 && vel_east == 0)) {
+      return best;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node& node = nodes[stack[--top]];
+
+      // Slab test of the ray against the node's box
+      float t0 = 0, t1 = best;
+      if (vel_north != 0) {
+	float a = (node.minNorth - north) / vel_north, b = (node.maxNorth - north) / vel_north;
+	t0 = std::max(t0, std::min(a, b));
+	t1 = std::min(t1, std::max(a, b));
+      } else if (north < node.minNorth || north > node.maxNorth) {
+	continue;
+      }
+      if (vel_east != 0) {
+	float a = (node.minEast - east) / vel_east, b = (node.maxEast - east) / vel_east;
+	t0 = std::max(t0, std::min(a, b));
+	t1 = std::min(t1, std::max(a, b));
+      } else if (east < node.minEast || east > node.maxEast) {
+	continue;
+      }
+      if (t0 > t1) {
+	continue;
+      }
+
+      if (node.count == 0) {
+	stack[top++] = node.left;
+	stack[top++] = node.right;
+	continue;
+      }
+      for (int i = node.first; i < node.first + node.count; i++) {
+	const Segment& s = segments[i];
+	float dn = s.b.north - s.a.north, de = s.b.east - s.a.east;
+	float denom = cross(vel_north, vel_east, dn, de);
+	if (denom == 0) {
+	  continue; // moving parallel to the wall
+	}
+	float pn = s.a.north - north, pe = s.a.east - east;
+	float t = cross(pn, pe, dn, de) / denom;
+	float u = cross(pn, pe, vel_north, vel_east) / denom;
+	if (t >= 0 && u >= 0 && u <= 1 && t < best) {
+	  best = t;
+	}
+      }
+    }
+    return best;
+  }
+
+  float Geofence::nearestSegment(float north, float east, Point& nearest) const {
+    float best2 = INF;
+    nearest = {north, east};
+    if (nodes.empty()) {
+      return best2;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node& node = nodes[stack[--top]];
+      float dn = std::max(std::max(node.minNorth - north, north - node.maxNorth), 0.0f);
+      float de = std::max(std::max(node.minEast  - east , east  - node.maxEast ), 0.0f);
+      if (dn * dn + de * de >= best2) {
+	continue;
+      }
+      if (node.count == 0) {
+	stack[top++] = node.left;
+	stack[top++] = node.right;
+	continue;
+      }
+      for (int i = node.first; i < node.first + node.count; i++) {
+	const Segment& s = segments[i];
+	float sn = s.b.north - s.a.north, se = s.b.east - s.a.east;
+	float len2 = sn * sn + se * se;
+	float u = len2 > 0 ? ((north - s.a.north) * sn + (east - s.a.east) * se) / len2 : 0;
+	u = std::min(std::max(u, 0.0f), 1.0f);
+	Point p = {s.a.north + u * sn, s.a.east + u * se};
+	float d2 = (p.north - north) * (p.north - north) + (p.east - east) * (p.east - east);
+	if (d2 < best2) {
+	  best2 = d2;
+	  nearest = p;
+	}
+      }
+    }
+    return best2;
+  }
+
+  float Geofence::distanceToWall(float north, float east) const {
+    Point nearest;
+    return sqrt(nearestSegment(north, east, nearest));
+  }
+
+  Geofence::Point Geofence::inwardDirection(float north, float east) const {
+    Point nearest;
+    float dist = sqrt(nearestSegment(north, east, nearest));
+    if (dist == 0 || dist == INF) {
+      return {0, 0};
+    }
+    // Away from the closest wall if inside, towards (and across) it if outside
+    float sign = contains(north, east) ? 1.0f : -1.0f;
+    return {sign * (north - nearest.north) / dist, sign * (east - nearest.east) / dist};
+  }
+
+}
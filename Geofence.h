@@ -0,0 +1,100 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_GEOFENCE_H
+#define MISSIONAPP_GEOFENCE_H
+
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A geofence: a polygonal region (with exclusion holes) in the
+   * north/east plane, extruded between a floor and a ceiling altitude.
+   * The walls (polygon edges) are indexed in a bounding-volume hierarchy,
+   * so queries take logarithmic time in the number of edges.
+   *
+   * File format (one entry per line, '#' starts a comment):
+   *   floor <altitude m>
+   *   ceiling <altitude m>
+   *   outer                  -- starts the outer polygon
+   *   hole                   -- starts an exclusion hole
+   *   <north m> <east m>     -- a vertex of the current polygon
+   * Polygons are closed implicitly; a point is inside the geofence iff
+   * it is inside an odd number of polygons (even-odd rule).
+   */
+  class Geofence {
+  public:
+    struct Point {
+      float north, east;
+    };
+
+  private:
+    struct Segment {
+      Point a, b;
+    };
+    // BVH node; a leaf iff count > 0 (segments [first, first+count))
+    struct Node {
+      float minNorth, minEast, maxNorth, maxEast;
+      int left, right;
+      int first, count;
+    };
+    static const int LEAF_SIZE = 4;
+
+    std::vector<Segment> segments;
+    std::vector<Node> nodes;
+    float floorZ = 0, ceilingZ = 0;
+
+    int buildNode(int first, int count);
+    float nearestSegment(float north, float east, Point& nearest) const;
+
+  public:
+    // Reads a geofence file and builds the BVH; returns false on error
+    bool load(const std::string& fname);
+    // Adds a closed polygon (outer boundary or hole)
+    void addPolygon(const std::vector<Point>& vertices);
+    void setAltitudes(float floor, float ceiling) { floorZ = floor; ceilingZ = ceiling; };
+    // (Re)builds the BVH; needed after adding polygons
+    void build();
+
+    float floorAltitude() const { return floorZ; };
+    float ceilingAltitude() const { return ceilingZ; };
+    int numWalls() const { return segments.size(); };
+
+    // true iff (north, east) is inside the polygonal region
+    bool contains(float north, float east) const;
+    // Time until moving from (north, east) at the given velocity hits a
+    // wall; infinity if it never does
+    float timeToWall(float north, float east, float vel_north, float vel_east) const;
+    // Distance from (north, east) to the closest wall
+    float distanceToWall(float north, float east) const;
+    // Unit direction from (north, east) towards the inside of the region,
+    // away from (or back across) the closest wall
+    Point inwardDirection(float north, float east) const;
+  };
+
+}
+
+#endif //MISSIONAPP_GEOFENCE_H
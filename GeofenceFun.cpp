@@ -0,0 +1,142 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "GeofenceFun.h"
+#include "Signal.h"
+#include "DroneUtil.h"
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+namespace cdra {
+
+  // TTI reported when the drone does not move towards any boundary (as TTIFun)
+  static const float NO_TTI = 1000.0f;
+
+  GeofenceFun::GeofenceFun(const Geofence& fence, float safeThreshold) :
+    fence(fence), safeThreshold(safeThreshold)
+  {
+    /* Drone has been going past some boundary for at least N=2 full seconds at max speed. */
+    minValue = -droneutil::MAX_DRONE_SPEED*2 - safeThreshold;
+
+    /* We don't need any sensitivity beyond 2x threshold */
+    maxValue = 2*safeThreshold - safeThreshold;
+
+    std::cout << "GFMax: " << std::to_string(maxValue) << std::endl;
+    std::cout << "GFMin: " << std::to_string(minValue) << std::endl;
+    std::cout << "GFMid: " << std::to_string(-minValue / (maxValue - minValue)) << std::endl;
+  }
+
+  GeofenceFun::~GeofenceFun()
+  {
+  }
+
+  float GeofenceFun::value(Signal *sig, int t) {
+    if (sig->length() - 1 < t)
+      throw "Signal unavailable!";
+    float pos_north_m   = sig->value("pos_north_m"  , t);
+    float pos_east_m    = sig->value("pos_east_m"   , t);
+    float pos_down_m    = sig->value("pos_down_m"   , t);
+    float vel_north_m_s = sig->value("vel_north_m_s", t);
+    float vel_east_m_s  = sig->value("vel_east_m_s" , t);
+    float vel_down_m_s  = sig->value("vel_down_m_s" , t);
+    float tti = computeTTI(pos_north_m, pos_east_m, -pos_down_m,
+			   vel_north_m_s, vel_east_m_s, -vel_down_m_s);
+    return normalizeValue(tti - safeThreshold);
+  }
+
+  float GeofenceFun::value(Signal *sig) {
+    return value(sig, sig->length() - 1);
+  }
+
+  void GeofenceFun::valueBatch(const StateBatch& states, float* out) {
+    const float* pn = states.data(StateBatch::POS_NORTH);
+    const float* pe = states.data(StateBatch::POS_EAST);
+    const float* pd = states.data(StateBatch::POS_DOWN);
+    const float* vn = states.data(StateBatch::VEL_NORTH);
+    const float* ve = states.data(StateBatch::VEL_EAST);
+    const float* vd = states.data(StateBatch::VEL_DOWN);
+    int n = states.size();
+    for (int i = 0; i < n; i++) {
+      out[i] = computeTTI(pn[i], pe[i], -pd[i], vn[i], ve[i], -vd[i]) - safeThreshold;
+    }
+    normalizeBatch(out, n);
+  }
+
+  bool GeofenceFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+    // No bounds on the polygon's TTI yet, only its range
+    normalizedRange(lower, upper);
+    return true;
+  }
+
+  bool GeofenceFun::closeToZBoundary(float pos_up_m, float vel_up_m_s) const {
+    float lowerz = fence.floorAltitude(), upperz = fence.ceilingAltitude();
+    return pos_up_m < lowerz || pos_up_m > upperz ||
+      (vel_up_m_s < 0 && (pos_up_m - lowerz) / (-vel_up_m_s) < safeThreshold) ||
+      (vel_up_m_s > 0 && (upperz - pos_up_m) / vel_up_m_s < safeThreshold);
+  }
+
+  float GeofenceFun::computeTTI(float pos_north_m, float pos_east_m, float pos_up_m,
+				float vel_north_m_s, float vel_east_m_s, float vel_up_m_s) const
+  {
+    float res = NO_TTI;
+    float lowerz = fence.floorAltitude(), upperz = fence.ceilingAltitude();
+
+    /* Time to hit boundary if within boundary.
+     * If outside boundary, provides meaningful negative value (as TTIFun) */
+    if (fence.contains(pos_north_m, pos_east_m)) {
+      res = std::min(res, fence.timeToWall(pos_north_m, pos_east_m, vel_north_m_s, vel_east_m_s));
+    } else {
+      // Distance outside, plus the speed away from the geofence (or the
+      // negative time to get back in when moving towards it)
+      float dist = fence.distanceToWall(pos_north_m, pos_east_m);
+      Geofence::Point in = fence.inwardDirection(pos_north_m, pos_east_m);
+      float vel_in = in.north * vel_north_m_s + in.east * vel_east_m_s;
+      res = std::min(res, vel_in > 0.0f ? -dist / vel_in : -dist + vel_in);
+    }
+    if(pos_up_m <= lowerz) { // Below
+      if(vel_up_m_s <= 0.0f) res = std::min(res, (pos_up_m - lowerz) + (vel_up_m_s));
+      if(vel_up_m_s > 0.0f) res = std::min(res, (pos_up_m - lowerz) / (vel_up_m_s));
+    } else if(pos_up_m >= upperz) { // Above
+      if(vel_up_m_s < 0.0f) res = std::min(res, (upperz - pos_up_m) / (vel_up_m_s));
+      if(vel_up_m_s >= 0.0f) res = std::min(res, (upperz - pos_up_m) - (vel_up_m_s));
+    } else { // In boundary (wrt z-axis)
+      if(vel_up_m_s < 0) res = std::min(res, fabsf(lowerz - pos_up_m) / (-vel_up_m_s));
+      if(vel_up_m_s > 0) res = std::min(res, fabsf(upperz - pos_up_m) / (vel_up_m_s));
+    }
+    return res;
+  }
+
+  bool GeofenceFun::prop(Signal *sig, int t) {
+    float val = value(sig, t);
+    return (val >= 0);
+  }
+
+  bool GeofenceFun::prop(Signal *sig) {
+    float val = value(sig);
+    return (val >= 0);
+  }
+
+}
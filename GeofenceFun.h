@@ -0,0 +1,71 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef GEOFENCEFUN_H_
+#define GEOFENCEFUN_H_
+
+#include "Signal.h"
+#include "SigFun.h"
+#include "Geofence.h"
+
+namespace cdra {
+
+  /**
+   * Geofence TTI function
+   * A function that takes a signal as an input and computes the
+   * Time-to-Intercept (TTI) of a polygonal geofence (see Geofence.h),
+   * by casting the velocity against its walls, floor and ceiling.
+   * Like TTIFun, it is negative outside of the geofence.
+   */
+  class GeofenceFun : public SigFun {
+
+    Geofence fence;
+    float safeThreshold;
+    float computeTTI(float pos_north_m, float pos_east_m, float pos_up_m,
+		     float vel_north_m_s, float vel_east_m_s, float vel_up_m_s) const;
+
+  public:
+    GeofenceFun(const Geofence& fence, float safeThreshold);
+    virtual ~GeofenceFun();
+    // returns the TTI at tick "t"
+    float value(Signal *sig, int t);
+    // returns the current TTI
+    float value(Signal *sig);
+    // returns true iff TTI at tick "t" within safe threshold
+    bool prop(Signal *sig, int t);
+    // returns true iff current TTI within safe threshold
+    bool prop(Signal *sig);
+    // returns the TTI for each state of the batch
+    void valueBatch(const StateBatch& states, float* out);
+    // bounds the TTI by its whole (normalized) range
+    bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
+    std::string propStr() { return "geofence tti - " + std::to_string(safeThreshold) + " >= 0"; };
+    std::string enforcer_name() { return "Boundary"; };
+    const Geofence& getGeofence() const { return fence; };
+    // true iff the vertical TTI is below the safe threshold (or outside the altitude range)
+    bool closeToZBoundary(float pos_up_m, float vel_up_m_s) const;
+  };
+
+}
+#endif	/* GEOFENCEFUN_H_ */
@@ -0,0 +1,248 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "Heightmap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cdra {
+
+  static const char MAGIC[8] = {'C', 'D', 'R', 'A', 'H', 'M', 'A', 'P'};
+
+  Heightmap::Heightmap() {
+    std::memset(&header, 0, sizeof(header));
+  }
+
+  Heightmap::~Heightmap() {
+    if (mapped) {
+      munmap(mapped, mappedSize);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  bool Heightmap::open(const std::string& fname) {
+    static_assert(sizeof(Header) == 64, "heightmap header must be 64 bytes");
+    fd = ::open(fname.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+      std::cerr << "Cannot open heightmap file: " << fname << std::endl;
+      return false;
+    }
+    if (pread(fd, &header, sizeof(Header), 0) != (ssize_t)sizeof(Header) ||
+	std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != 1 ||
+	header.tileSize == 0 || header.rows < 2 || header.cols < 2 || header.cellSize <= 0) {
+      std::cerr << "Bad heightmap header: " << fname << std::endl;
+      return false;
+    }
+
+    tilesAcross = (header.cols + header.tileSize - 1) / header.tileSize;
+    size_t tilesDown = (header.rows + header.tileSize - 1) / header.tileSize;
+    size_t tileBytes = (size_t)header.tileSize * header.tileSize * sizeof(int16_t);
+    mappedSize = sizeof(Header) + tilesDown * tilesAcross * tileBytes;
+    if ((size_t)st.st_size < mappedSize) {
+      std::cerr << "Truncated heightmap file: " << fname << std::endl;
+      return false;
+    }
+
+    // Only map the file; tiles are paged in when first looked up
+    mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      mapped = nullptr;
+      std::cerr << "Cannot map heightmap file: " << fname << std::endl;
+      return false;
+    }
+    samples = (const int16_t*)((const char*)mapped + sizeof(Header));
+
+    std::cout << "Heightmap: " << header.rows << "x" << header.cols << " samples, "
+	      << header.cellSize << " m cells, " << tilesDown * tilesAcross << " tiles" << std::endl;
+    return true;
+  }
+
+  bool Heightmap::create(const std::string& fname, const std::vector<float>& altitudes,
+			 int rows, int cols, float originNorth, float originEast,
+			 float cellSize, int tileSize, float scale) {
+    if (rows < 2 || cols < 2 || tileSize <= 0 || altitudes.size() != (size_t)rows * cols) {
+      return false;
+    }
+    float low  = *std::min_element(altitudes.begin(), altitudes.end());
+    float high = *std::max_element(altitudes.begin(), altitudes.end());
+    if ((high - low) / scale > 65534) {
+      return false; // not representable with this scale
+    }
+
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = 1;
+    h.tileSize = tileSize;
+    h.rows = rows;
+    h.cols = cols;
+    h.originNorth = originNorth;
+    h.originEast = originEast;
+    h.cellSize = cellSize;
+    h.scale = scale;
+    h.offset = (low + high) / 2;
+
+    std::ofstream out(fname, std::ios::binary);
+    out.write((const char*)&h, sizeof(h));
+    int tilesAcross = (cols + tileSize - 1) / tileSize;
+    int tilesDown = (rows + tileSize - 1) / tileSize;
+    std::vector<int16_t> tile(tileSize * tileSize);
+    for (int tr = 0; tr < tilesDown; tr++) {
+      for (int tc = 0; tc < tilesAcross; tc++) {
+	for (int r = 0; r < tileSize; r++) {
+	  for (int c = 0; c < tileSize; c++) {
+	    // Pad edge tiles with the closest sample
+	    int row = std::min(tr * tileSize + r, rows - 1);
+	    int col = std::min(tc * tileSize + c, cols - 1);
+	    tile[r * tileSize + c] = (int16_t)lrintf((altitudes[row * cols + col] - h.offset) / scale);
+	  }
+	}
+	out.write((const char*)tile.data(), tile.size() * sizeof(int16_t));
+      }
+    }
+    return (bool)out;
+  }
+
+  std::shared_ptr<Heightmap> Heightmap::shared(const std::string& fname) {
+    static std::map<std::string, std::weak_ptr<Heightmap> > opened;
+    std::shared_ptr<Heightmap> map = opened[fname].lock();
+    if (!map) {
+      map = std::make_shared<Heightmap>();
+      if (!map->open(fname)) {
+	return nullptr;
+      }
+      opened[fname] = map;
+    }
+    return map;
+  }
+
+  const float* Heightmap::tile(int index) {
+    useCounter++;
+    if (cache[lastSlot].tile == index) {
+      cache[lastSlot].lastUse = useCounter;
+      return cache[lastSlot].heights.data();
+    }
+
+    int victim = 0;
+    for (int s = 0; s < CACHE_TILES; s++) {
+      if (cache[s].tile == index) {
+	cache[s].lastUse = useCounter;
+	lastSlot = s;
+	return cache[s].heights.data();
+      }
+      if (cache[s].lastUse < cache[victim].lastUse) {
+	victim = s;
+      }
+    }
+
+    // Miss: decode the tile from the mapping into the least recently used slot
+    int n = header.tileSize * header.tileSize;
+    const int16_t* raw = samples + (size_t)index * n;
+    CacheSlot& slot = cache[victim];
+    slot.heights.resize(n);
+    for (int i = 0; i < n; i++) {
+      slot.heights[i] = raw[i] * header.scale + header.offset;
+    }
+    slot.tile = index;
+    slot.lastUse = useCounter;
+    lastSlot = victim;
+    return slot.heights.data();
+  }
+
+  float Heightmap::sample(int row, int col) {
+    int ts = header.tileSize;
+    const float* t = tile((row / ts) * tilesAcross + col / ts);
+    return t[(row % ts) * ts + col % ts];
+  }
+
+  float Heightmap::interpolate(float north, float east) {
+    int rows = header.rows, cols = header.cols;
+    float r = (north - header.originNorth) / header.cellSize;
+    float c = (east  - header.originEast ) / header.cellSize;
+    r = std::min(std::max(r, 0.0f), (float)(rows - 1));
+    c = std::min(std::max(c, 0.0f), (float)(cols - 1));
+    int r0 = std::min((int)r, rows - 2), c0 = std::min((int)c, cols - 2);
+    float fr = r - r0, fc = c - c0;
+    float h00 = sample(r0, c0)    , h01 = sample(r0, c0 + 1);
+    float h10 = sample(r0 + 1, c0), h11 = sample(r0 + 1, c0 + 1);
+    return (h00 * (1 - fc) + h01 * fc) * (1 - fr) + (h10 * (1 - fc) + h11 * fc) * fr;
+  }
+
+  float Heightmap::height(float north, float east) {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    return interpolate(north, east);
+  }
+
+  void Heightmap::heights(const float* north, const float* east, int n, float* out) {
+    // Candidates are close to each other, so most lookups hit the last tile
+    std::lock_guard<std::mutex> guard(cacheLock);
+    for (int i = 0; i < n; i++) {
+      out[i] = interpolate(north[i], east[i]);
+    }
+  }
+
+  void Heightmap::heightRange(float minNorth, float minEast, float maxNorth, float maxEast,
+			      float& low, float& high) {
+    // Bilinear interpolation stays within the samples of the covering cells
+    int rows = header.rows, cols = header.cols;
+    auto toRow = [&](float north) {
+      return std::min(std::max((north - header.originNorth) / header.cellSize, 0.0f), (float)(rows - 1));
+    };
+    auto toCol = [&](float east) {
+      return std::min(std::max((east - header.originEast) / header.cellSize, 0.0f), (float)(cols - 1));
+    };
+    int r0 = (int)floorf(toRow(minNorth)), r1 = (int)ceilf(toRow(maxNorth));
+    int c0 = (int)floorf(toCol(minEast)) , c1 = (int)ceilf(toCol(maxEast));
+    std::lock_guard<std::mutex> guard(cacheLock);
+    low = high = sample(r0, c0);
+    for (int r = r0; r <= r1; r++) {
+      for (int c = c0; c <= c1; c++) {
+	float h = sample(r, c);
+	low  = std::min(low, h);
+	high = std::max(high, h);
+      }
+    }
+  }
+
+  void Heightmap::gradient(float north, float east, float& d_north, float& d_east) {
+    float step = header.cellSize / 2;
+    std::lock_guard<std::mutex> guard(cacheLock);
+    d_north = (interpolate(north + step, east) - interpolate(north - step, east)) / (2 * step);
+    d_east  = (interpolate(north, east + step) - interpolate(north, east - step)) / (2 * step);
+  }
+
+}
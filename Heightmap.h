@@ -0,0 +1,118 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_HEIGHTMAP_H
+#define MISSIONAPP_HEIGHTMAP_H
+
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A terrain elevation grid, memory-mapped from a tiled binary file.
+   *
+   * The file is a 64-byte header followed by square tiles of int16
+   * samples; pages of the file are only read when a tile is first used,
+   * so opening a large terrain is cheap. Decoded tiles are kept in a small
+   * LRU cache. Lookups are bilinear; positions outside the grid use the
+   * closest edge sample.
+   *
+   * Header (little-endian):
+   *   char[8] magic "CDRAHMAP", uint32 version (1), uint32 tile size
+   *   (samples per side), uint32 rows (north), uint32 cols (east),
+   *   float north/east of sample (0, 0) in m, float cell size in m,
+   *   float scale and offset (altitude = sample * scale + offset, in m)
+   * Tiles are stored row-major (by north, then east), and so are the
+   * samples of a tile; edge tiles are padded to the full tile size.
+   *
+   * Lookups are thread-safe: the tile cache is shared by all of them and
+   * guarded by a lock, taken once per call (once per batch for heights).
+   */
+  class Heightmap {
+  public:
+    static const int CACHE_TILES = 16;
+
+  private:
+    struct Header {
+      char magic[8];
+      uint32_t version, tileSize, rows, cols;
+      float originNorth, originEast, cellSize, scale, offset;
+      char reserved[20];
+    };
+    struct CacheSlot {
+      int tile = -1;
+      unsigned long lastUse = 0;
+      std::vector<float> heights;
+    };
+
+    Header header;
+    int fd = -1;
+    void* mapped = nullptr;            // mapped file
+    const int16_t* samples = nullptr;  // mapped tiles
+    size_t mappedSize = 0;
+    int tilesAcross = 0;               // tiles per row (east)
+
+    CacheSlot cache[CACHE_TILES];
+    unsigned long useCounter = 0;
+    int lastSlot = 0;
+    std::mutex cacheLock;              // guards the cache
+
+    // The following require cacheLock to be held
+    const float* tile(int index);
+    float sample(int row, int col);
+    float interpolate(float north, float east);
+
+  public:
+    Heightmap();
+    ~Heightmap();
+    Heightmap(const Heightmap&) = delete;
+    Heightmap& operator=(const Heightmap&) = delete;
+
+    // Maps a heightmap file; returns false on error
+    bool open(const std::string& fname);
+    // Writes a heightmap file from row-major altitudes (rows x cols, in m)
+    static bool create(const std::string& fname, const std::vector<float>& altitudes,
+		       int rows, int cols, float originNorth, float originEast,
+		       float cellSize, int tileSize = 64, float scale = 0.01f);
+    // Heightmap of a file shared by every user of that file (null on error)
+    static std::shared_ptr<Heightmap> shared(const std::string& fname);
+
+    // Ground altitude (m, up) at a position
+    float height(float north, float east);
+    // Ground altitudes for "n" positions
+    void heights(const float* north, const float* east, int n, float* out);
+    // Lowest and highest ground altitude within a north/east box
+    void heightRange(float minNorth, float minEast, float maxNorth, float maxEast,
+		     float& low, float& high);
+    // Ground slope (m/m) along north and east at a position
+    void gradient(float north, float east, float& d_north, float& d_east);
+  };
+
+}
+
+#endif //MISSIONAPP_HEIGHTMAP_H
@@ -0,0 +1,179 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "KdTree.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <sstream>
+
+namespace cdra {
+
+  bool KdTree::load(const std::string& fname) {
+    std::ifstream infile(fname);
+    if (!infile) {
+      std::cerr << "Cannot open obstacle file: " << fname << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(infile, line)) {
+      line = line.substr(0, line.find('#'));
+      std::istringstream iss(line);
+      Sphere s;
+      float altitude;
+      if (!(iss >> s.pos[0])) {
+	continue; // empty line
+      }
+      if (!(iss >> s.pos[1] >> altitude)) {
+	std::cerr << "Bad obstacle line: " << line << std::endl;
+	return false;
+      }
+      s.pos[2] = -altitude;
+      if (!(iss >> s.radius)) {
+	s.radius = 0;
+      }
+      if (s.radius < 0) {
+	std::cerr << "Bad obstacle line: " << line << std::endl;
+	return false;
+      }
+      add(s);
+    }
+    build();
+    std::cout << "Obstacles: " << spheres.size() << std::endl;
+    return !spheres.empty();
+  }
+
+  void KdTree::build() {
+    axes.assign(spheres.size(), 0);
+    maxRadius = 0;
+    for (auto& s : spheres) {
+      maxRadius = std::max(maxRadius, s.radius);
+    }
+    build(0, spheres.size());
+  }
+
+  void KdTree::build(int begin, int end) {
+    if (begin >= end) {
+      return;
+    }
+    // Split the widest axis at the median
+    float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX}, hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (int i = begin; i < end; i++) {
+      for (int a = 0; a < 3; a++) {
+	lo[a] = std::min(lo[a], spheres[i].pos[a]);
+	hi[a] = std::max(hi[a], spheres[i].pos[a]);
+      }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; a++) {
+      if (hi[a] - lo[a] > hi[axis] - lo[axis]) {
+	axis = a;
+      }
+    }
+    int mid = (begin + end) / 2;
+    std::nth_element(spheres.begin() + begin, spheres.begin() + mid, spheres.begin() + end,
+		     [axis](const Sphere& s1, const Sphere& s2) { return s1.pos[axis] < s2.pos[axis]; });
+    axes[mid] = axis;
+    build(begin, mid);
+    build(mid + 1, end);
+  }
+
+  float KdTree::surfaceDistance(int i, float north, float east, float down) const {
+    const Sphere& s = spheres[i];
+    float dn = north - s.pos[0], de = east - s.pos[1], dd = down - s.pos[2];
+    return sqrtf(dn*dn + de*de + dd*dd) - s.radius;
+  }
+
+  void KdTree::nearest(int begin, int end, const float* q, int& best, float& bestDist) const {
+    if (begin >= end) {
+      return;
+    }
+    int mid = (begin + end) / 2;
+    float dist = surfaceDistance(mid, q[0], q[1], q[2]);
+    if (dist < bestDist) {
+      bestDist = dist;
+      best = mid;
+    }
+    // Near side first; the surfaces on the far side are at least
+    // |diff| - maxRadius away
+    float diff = q[axes[mid]] - spheres[mid].pos[axes[mid]];
+    if (diff < 0) {
+      nearest(begin, mid, q, best, bestDist);
+      if (-diff - maxRadius < bestDist)
+	nearest(mid + 1, end, q, best, bestDist);
+    } else {
+      nearest(mid + 1, end, q, best, bestDist);
+      if (diff - maxRadius < bestDist)
+	nearest(begin, mid, q, best, bestDist);
+    }
+  }
+
+  int KdTree::nearest(float north, float east, float down, float& dist) const {
+    float q[3] = {north, east, down};
+    int best = -1;
+    dist = FLT_MAX;
+    nearest(0, spheres.size(), q, best, dist);
+    return best;
+  }
+
+  void KdTree::nearest(const float* north, const float* east, const float* down, int n,
+		       float* dist, int* index) const {
+    int best = -1;
+    for (int i = 0; i < n; i++) {
+      float q[3] = {north[i], east[i], down[i]};
+      // The previous nearest obstacle bounds the search
+      float bestDist = best < 0 ? FLT_MAX : surfaceDistance(best, q[0], q[1], q[2]);
+      nearest(0, spheres.size(), q, best, bestDist);
+      dist[i] = bestDist;
+      if (index) {
+	index[i] = best;
+      }
+    }
+  }
+
+  void KdTree::within(int begin, int end, const float* q, float range, std::vector<int>& out) const {
+    if (begin >= end) {
+      return;
+    }
+    int mid = (begin + end) / 2;
+    if (surfaceDistance(mid, q[0], q[1], q[2]) <= range) {
+      out.push_back(mid);
+    }
+    float diff = q[axes[mid]] - spheres[mid].pos[axes[mid]];
+    if (diff - maxRadius <= range)
+      within(begin, mid, q, range, out);
+    if (-diff - maxRadius <= range)
+      within(mid + 1, end, q, range, out);
+  }
+
+  void KdTree::within(float north, float east, float down, float range, std::vector<int>& out) const {
+    float q[3] = {north, east, down};
+    out.clear();
+    within(0, spheres.size(), q, range, out);
+  }
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_KDTREE_H
+#define MISSIONAPP_KDTREE_H
+
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A k-d tree of static spherical obstacles (points are spheres of radius 0)
+   * for nearest-surface distance queries in logarithmic time.
+   * The tree is implicit: the obstacles are stored in tree order, the node
+   * of a range [begin, end) being its middle element.
+   * Obstacle positions are in NED (as in the signal).
+   *
+   * File format: one obstacle per line ('#' starts a comment)
+   *   <north m> <east m> <altitude m> [<radius m>]
+   */
+  class KdTree {
+  public:
+    struct Sphere {
+      float pos[3]; // north, east, down
+      float radius;
+    };
+
+  private:
+    std::vector<Sphere> spheres;
+    std::vector<unsigned char> axes; // split axis of each node
+    float maxRadius = 0;
+
+    void build(int begin, int end);
+    void nearest(int begin, int end, const float* q, int& best, float& bestDist) const;
+    void within(int begin, int end, const float* q, float range, std::vector<int>& out) const;
+
+  public:
+    // Reads an obstacle file and builds the tree; returns false on error
+    bool load(const std::string& fname);
+    void add(const Sphere& sphere) { spheres.push_back(sphere); };
+    // (Re)builds the tree; needed after adding obstacles (reorders them)
+    void build();
+
+    int size() const { return spheres.size(); };
+    const Sphere& sphere(int i) const { return spheres[i]; };
+    // Distance from a position to the surface of obstacle "i" (negative inside)
+    float surfaceDistance(int i, float north, float east, float down) const;
+    // Index of the obstacle with the nearest surface (-1 if there are none);
+    // sets "dist" to the distance to that surface
+    int nearest(float north, float east, float down, float& dist) const;
+    // Nearest surface distances (and obstacle indices, if "index" is given) of
+    // "n" positions; each query starts from the previous query's obstacle, so
+    // nearby positions (e.g., candidate actions) are pruned faster
+    void nearest(const float* north, const float* east, const float* down, int n,
+		 float* dist, int* index = nullptr) const;
+    // Indices of the obstacles whose surface is within "range" of a position
+    void within(float north, float east, float down, float range, std::vector<int>& out) const;
+  };
+
+}
+
+#endif //MISSIONAPP_KDTREE_H
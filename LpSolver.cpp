@@ -0,0 +1,245 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "LpSolver.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace cdra {
+
+  static const double EPS = 1e-9;
+
+  constexpr double LpSolver::INF;
+
+  LpSolver::LpSolver(int numVars)
+    : numVars(numVars), lower(numVars, -INF), upper(numVars, INF), objective(numVars, 0) {
+  }
+
+  void LpSolver::setBounds(int var, double lo, double hi) {
+    lower[var] = lo;
+    upper[var] = hi;
+  }
+
+  void LpSolver::setObjective(const std::vector<double>& c) {
+    objective = c;
+  }
+
+  void LpSolver::addConstraint(const std::vector<double>& a, double b) {
+    rows.push_back(a);
+    bounds.push_back(b);
+  }
+
+  /* Simplex tableau: "t" has one row per constraint plus the objective row
+   * (last), and one column per variable plus the right-hand side (last) */
+  struct Tableau {
+    std::vector<std::vector<double>> t;
+    std::vector<int> basis;   // basic variable of each constraint row
+    int cols;                 // variables (without the right-hand side)
+
+    void pivot(int row, int col) {
+      std::vector<double>& p = t[row];
+      double inv = 1 / p[col];
+      for (double& v : p) {
+	v *= inv;
+      }
+      for (unsigned int r = 0; r < t.size(); r++) {
+	if (r == (unsigned int)row || t[r][col] == 0) {
+	  continue;
+	}
+	double f = t[r][col];
+	for (int c = 0; c <= cols; c++) {
+	  t[r][c] -= f * p[c];
+	}
+      }
+      basis[row] = col;
+    }
+
+    // Maximizes the objective row over the columns [0, allowed);
+    // false if unbounded
+    bool optimize(int allowed) {
+      int m = basis.size();
+      while (true) {
+	// Bland's rule: lowest improving column, then lowest basic variable
+	int col = -1;
+	for (int c = 0; c < allowed; c++) {
+	  if (t[m][c] < -EPS) {
+	    col = c;
+	    break;
+	  }
+	}
+	if (col < 0) {
+	  return true;
+	}
+	int row = -1;
+	double best = 0;
+	for (int r = 0; r < m; r++) {
+	  if (t[r][col] > EPS) {
+	    double ratio = t[r][cols] / t[r][col];
+	    if (row < 0 || ratio < best - EPS || (ratio < best + EPS && basis[r] < basis[row])) {
+	      row = r;
+	      best = ratio;
+	    }
+	  }
+	}
+	if (row < 0) {
+	  return false;
+	}
+	pivot(row, col);
+      }
+    }
+  };
+
+  LpSolver::Status LpSolver::maximize(std::vector<double>& x, double& value) const {
+    // Map every variable to non-negative columns: x = lower + y, x = upper - y,
+    // or x = y+ - y- when free; finite ranges add y <= upper - lower
+    struct Column { int var; double sign; };
+    std::vector<Column> columns;
+    std::vector<double> offset(numVars, 0);
+    std::vector<std::vector<double>> a;
+    std::vector<double> b;
+    std::vector<std::pair<int, double>> ranges;
+    for (int v = 0; v < numVars; v++) {
+      if (lower[v] > -INF) {
+	offset[v] = lower[v];
+	columns.push_back({v, 1});
+	if (upper[v] < INF) {
+	  ranges.push_back({(int)columns.size() - 1, upper[v] - lower[v]});
+	}
+      } else if (upper[v] < INF) {
+	offset[v] = upper[v];
+	columns.push_back({v, -1});
+      } else {
+	columns.push_back({v, 1});
+	columns.push_back({v, -1});
+      }
+    }
+    int n = columns.size();
+    for (unsigned int i = 0; i < rows.size(); i++) {
+      std::vector<double> row(n);
+      double rhs = bounds[i];
+      for (int c = 0; c < n; c++) {
+	row[c] = rows[i][columns[c].var] * columns[c].sign;
+      }
+      for (int v = 0; v < numVars; v++) {
+	rhs -= rows[i][v] * offset[v];
+      }
+      a.push_back(row);
+      b.push_back(rhs);
+    }
+    for (auto& range : ranges) {
+      std::vector<double> row(n, 0);
+      row[range.first] = 1;
+      a.push_back(row);
+      b.push_back(range.second);
+    }
+
+    // Columns: n structural, m slacks, then one artificial per row with b < 0
+    int m = a.size();
+    std::vector<int> artificialRows;
+    for (int r = 0; r < m; r++) {
+      if (b[r] < 0) {
+	artificialRows.push_back(r);
+      }
+    }
+    int numArtificial = artificialRows.size();
+    Tableau tab;
+    tab.cols = n + m + numArtificial;
+    tab.t.assign(m + 1, std::vector<double>(tab.cols + 1, 0));
+    tab.basis.resize(m);
+    int nextArtificial = n + m;
+    for (int r = 0; r < m; r++) {
+      double sign = b[r] < 0 ? -1 : 1;
+      for (int c = 0; c < n; c++) {
+	tab.t[r][c] = sign * a[r][c];
+      }
+      tab.t[r][n + r] = sign;
+      tab.t[r][tab.cols] = sign * b[r];
+      if (b[r] < 0) {
+	tab.t[r][nextArtificial] = 1;
+	tab.basis[r] = nextArtificial++;
+      } else {
+	tab.basis[r] = n + r;
+      }
+    }
+
+    // Phase I: drive the artificial variables to 0 (maximize -sum)
+    if (numArtificial > 0) {
+      for (int r : artificialRows) {
+	// (the artificial columns stay 0 once their own rows are subtracted)
+	for (int c = 0; c <= tab.cols; c++) {
+	  if (c < n + m || c == tab.cols) {
+	    tab.t[m][c] -= tab.t[r][c];
+	  }
+	}
+      }
+      tab.optimize(n + m);
+      if (tab.t[m][tab.cols] < -1e-7) {
+	return INFEASIBLE;
+      }
+      // Pivot the artificial variables left at 0 out of the basis
+      for (int r = 0; r < m; r++) {
+	if (tab.basis[r] >= n + m) {
+	  for (int c = 0; c < n + m; c++) {
+	    if (fabs(tab.t[r][c]) > EPS) {
+	      tab.pivot(r, c);
+	      break;
+	    }
+	  }
+	}
+      }
+    }
+
+    // Phase II: the objective over the structural columns
+    std::fill(tab.t[m].begin(), tab.t[m].end(), 0);
+    for (int c = 0; c < n; c++) {
+      tab.t[m][c] = -objective[columns[c].var] * columns[c].sign;
+    }
+    for (int r = 0; r < m; r++) {
+      double f = tab.t[m][tab.basis[r]];
+      if (f != 0) {
+	for (int c = 0; c <= tab.cols; c++) {
+	  tab.t[m][c] -= f * tab.t[r][c];
+	}
+      }
+    }
+    if (!tab.optimize(n + m)) {
+      return UNBOUNDED;
+    }
+
+    x = offset;
+    for (int r = 0; r < m; r++) {
+      if (tab.basis[r] < n) {
+	const Column& column = columns[tab.basis[r]];
+	x[column.var] += column.sign * tab.t[r][tab.cols];
+      }
+    }
+    value = 0;
+    for (int v = 0; v < numVars; v++) {
+      value += objective[v] * x[v];
+    }
+    return OPTIMAL;
+  }
+
+}
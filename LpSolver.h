@@ -0,0 +1,74 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_LPSOLVER_H
+#define MISSIONAPP_LPSOLVER_H
+
+#include <limits>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A small dense linear program solver (two-phase simplex on a full
+   * tableau, Bland's rule), for the few-variable programs built by the
+   * coordinators:
+   *   maximize c . x  subject to  a_i . x <= b_i,  lower <= x <= upper
+   * Bounds may be infinite; variables are free by default.
+   * Cost is O(rows * columns) per pivot, so keep programs to a few dozen
+   * rows and columns.
+   */
+  class LpSolver {
+  public:
+    enum Status {
+      OPTIMAL,
+      INFEASIBLE,
+      UNBOUNDED
+    };
+    static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  private:
+    int numVars;
+    std::vector<double> lower, upper;
+    std::vector<double> objective;
+    std::vector<std::vector<double>> rows;
+    std::vector<double> bounds;
+
+  public:
+    LpSolver(int numVars);
+
+    // Bounds of variable "var" (either may be infinite)
+    void setBounds(int var, double lo, double hi);
+    // Objective coefficients (one per variable)
+    void setObjective(const std::vector<double>& c);
+    // Adds the constraint a . x <= b (one coefficient per variable)
+    void addConstraint(const std::vector<double>& a, double b);
+
+    // Maximizes the objective; on OPTIMAL, sets "x" and "value"
+    Status maximize(std::vector<double>& x, double& value) const;
+  };
+
+}
+
+#endif //MISSIONAPP_LPSOLVER_H
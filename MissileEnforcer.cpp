@@ -38,7 +38,22 @@ namespace cdra {
         enforcerName = "Missile Enforcer";
 	
         // Property: Current DTG is maintained above a safe threshold
-        missileFun = new ReconFun(missileElevation, acceptableThreshold, lowerx, lowery, upperx, uppery);
+        if (!droneutil::MISSILE_ZONE_FILE.empty()) {
+            // Several missile areas, each with its own elevation
+            zones = std::make_shared<ZoneSet>();
+            if (!zones->load(droneutil::MISSILE_ZONE_FILE))
+                throw "Missile zones unavailable!";
+            missileFun = new ReconFun(zones);
+        } else {
+            missileFun = new ReconFun(missileElevation, acceptableThreshold, lowerx, lowery, upperx, uppery);
+        }
+        if (!droneutil::TERRAIN_FILE.empty()) {
+            // Missile elevation is above the terrain
+            terrain = Heightmap::shared(droneutil::TERRAIN_FILE);
+            if (!terrain)
+                throw "Terrain unavailable!";
+            missileFun->setTerrain(terrain);
+        }
 	prop   = new Prop(missileFun);
     }
 
@@ -65,9 +80,22 @@ namespace cdra {
 
         std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> newNEDs;
 
-	float ego_elevation = -store->getSignal()->value("pos_down_m");
+	Signal* sig = store->getSignal();
+	float pos_north_m = sig->value("pos_north_m");
+	float pos_east_m  = sig->value("pos_east_m");
+	float ego_elevation = -sig->value("pos_down_m");
+	if (terrain)
+	  ego_elevation -= terrain->height(pos_north_m, pos_east_m);
+
+	// Elevation of the missile area we're in (if any)
+	float goal_elevation = missileElevation;
+	if (zones) {
+	  int zone = zones->find(pos_north_m, pos_east_m);
+	  if (zone >= 0)
+	    goal_elevation = zones->zone(zone).goal_z;
+	}
 	
-	float down_vel = ego_elevation < missileElevation ? -droneutil::MAX_DRONE_SPEED : droneutil::MAX_DRONE_SPEED;
+	float down_vel = ego_elevation < goal_elevation ? -droneutil::MAX_DRONE_SPEED : droneutil::MAX_DRONE_SPEED;
 	
         Offboard::VelocityNEDYaw newNED{
 	  0,
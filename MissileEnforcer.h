@@ -45,6 +45,10 @@ namespace cdra {
 
       // Acceptable threshold
       float acceptableThreshold = 1.0;
+
+      // Set by MISSILE_ZONE_FILE/TERRAIN_FILE (replace the XY region above/flat ground)
+      std::shared_ptr<ZoneSet> zones;
+      std::shared_ptr<Heightmap> terrain;
 	
     protected:
         std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
@@ -0,0 +1,163 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <math.h>
+
+#include "MpcCoordinator.h"
+#include "ActionScorer.h"
+#include "DroneUtil.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+
+namespace cdra {
+
+  MpcCoordinator::MpcCoordinator(std::shared_ptr<dronecode_sdk::Offboard> offboard,
+				 std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
+				 std::shared_ptr<StateStore> store)
+    : RobustnessCoordinator(offboard, telemetry, store) {}
+
+  MpcCoordinator::~MpcCoordinator() {}
+
+  Offboard::VelocityNEDYaw MpcCoordinator::synthesize(const vector<StlExpr*>& properties,
+						      const vector<float>& prop_weights,
+						      const vector<Offboard::VelocityNEDYaw>& actions,
+						      int t) {
+    const float ELITE_FRACTION = 0.2;   // of each generation, used to refit the Gaussians
+    const float SMOOTHING      = 0.7;   // weight of the refit Gaussians (vs. the previous ones)
+    const float MIN_STD        = 0.05 * droneutil::MAX_DRONE_SPEED;
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto deadline = synthesisDeadline();
+    int horizon = max(droneutil::MPC_HORIZON, 1u);
+    int population = max(droneutil::MPC_POPULATION, 2u);
+    int num_elites = max((int)ceil(ELITE_FRACTION * population), 2);
+    SequenceScorer scorer(properties, prop_weights, store->getSignal(), t, horizon, *model, pool.get());
+
+    // Seeds: the previous plan shifted by a step, and each conflicting action held
+    vector<Offboard::VelocityNEDYaw> sequences;
+    if(planTick >= 0 && planTick == t - 1 && (int)plan.size() == horizon) {
+      sequences.insert(sequences.end(), plan.begin() + 1, plan.end());
+      sequences.push_back(plan.back());
+    }
+    for(auto& action : actions) {
+      sequences.insert(sequences.end(), horizon, action);
+    }
+    vector<float> scores;
+    scorer.score(sequences, scores);
+    unsigned int scored = scores.size();
+    int argmax = max_element(scores.begin(), scores.end()) - scores.begin();
+    vector<Offboard::VelocityNEDYaw> best(sequences.begin() + argmax * horizon,
+					  sequences.begin() + (argmax + 1) * horizon);
+    float best_score = scores[argmax];
+
+    // One Gaussian per step: centered on the best seed, as wide as the conflicting actions
+    vector<float> mean(3 * horizon), std_dev(3 * horizon);
+    float spread[3] = {0, 0, 0}, center[3] = {0, 0, 0};
+    for(auto& action : actions) {
+      center[0] += action.north_m_s / actions.size();
+      center[1] += action.east_m_s  / actions.size();
+      center[2] += action.down_m_s  / actions.size();
+    }
+    for(auto& action : actions) {
+      float d[3] = { action.north_m_s - center[0], action.east_m_s - center[1], action.down_m_s - center[2] };
+      for(int k = 0; k < 3; k++) { spread[k] += d[k]*d[k] / actions.size(); }
+    }
+    for(int s = 0; s < horizon; s++) {
+      float m[3] = { best[s].north_m_s, best[s].east_m_s, best[s].down_m_s };
+      for(int k = 0; k < 3; k++) {
+	mean[3*s + k] = m[k];
+	std_dev[3*s + k] = max((float)sqrt(spread[k]), MIN_STD);
+      }
+      if(!droneutil::EGO_Z_VELOCITY) { mean[3*s + 2] = std_dev[3*s + 2] = 0; }
+    }
+
+    vector<int> order(population);
+    sequences.resize(population * horizon);
+    float z[3];
+    for(unsigned int gen = 0; gen < droneutil::MPC_GENERATIONS; gen++) {
+      // (at least one generation, so a late tick still improves on the seeds)
+      if(gen > 0 && std::chrono::steady_clock::now() >= deadline) {
+	break;
+      }
+      for(int i = 0; i < population; i++) {
+	for(int s = 0; s < horizon; s++) {
+	  generator->nextNormal(z);
+	  auto& action = sequences[i*horizon + s];
+	  action = { mean[3*s]     + std_dev[3*s]     * z[0],
+		     mean[3*s + 1] + std_dev[3*s + 1] * z[1],
+		     mean[3*s + 2] + std_dev[3*s + 2] * z[2] };
+	  if(droneutil::getMagnitude(action) == 0) { action.north_m_s = 1; }
+	  droneutil::scaleToMaxVelocity(action);
+	}
+      }
+      scorer.score(sequences, scores);
+      scored += population;
+
+      // Elites: the highest scores (ties broken by sample order, for determinism)
+      for(int i = 0; i < population; i++) { order[i] = i; }
+      partial_sort(order.begin(), order.begin() + num_elites, order.end(),
+		   [&scores](int i1, int i2) { return scores[i1] > scores[i2] || (scores[i1] == scores[i2] && i1 < i2); });
+      if(scores[order[0]] > best_score) {
+	best_score = scores[order[0]];
+	best.assign(sequences.begin() + order[0] * horizon, sequences.begin() + (order[0] + 1) * horizon);
+      }
+
+      // Refit each step's Gaussian to the elites
+      for(int s = 0; s < horizon; s++) {
+	float elite_mean[3] = {0, 0, 0}, elite_var[3] = {0, 0, 0};
+	for(int e = 0; e < num_elites; e++) {
+	  auto& action = sequences[order[e]*horizon + s];
+	  elite_mean[0] += action.north_m_s / num_elites;
+	  elite_mean[1] += action.east_m_s  / num_elites;
+	  elite_mean[2] += action.down_m_s  / num_elites;
+	}
+	for(int e = 0; e < num_elites; e++) {
+	  auto& action = sequences[order[e]*horizon + s];
+	  float d[3] = { action.north_m_s - elite_mean[0], action.east_m_s - elite_mean[1], action.down_m_s - elite_mean[2] };
+	  for(int k = 0; k < 3; k++) { elite_var[k] += d[k]*d[k] / num_elites; }
+	}
+	for(int k = 0; k < 3; k++) {
+	  mean[3*s + k]    = SMOOTHING * elite_mean[k] + (1 - SMOOTHING) * mean[3*s + k];
+	  std_dev[3*s + k] = max(SMOOTHING * (float)sqrt(elite_var[k]) + (1 - SMOOTHING) * std_dev[3*s + k], MIN_STD);
+	}
+	if(!droneutil::EGO_Z_VELOCITY) { mean[3*s + 2] = std_dev[3*s + 2] = 0; }
+      }
+    }
+
+    cout << "MPC best robustness over " << horizon << " steps: " << best_score << endl;
+    store->recordStat("candidates_scored", scored);
+    store->recordStat("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+
+    // Perform the first action, keep the rest for the next tick
+    plan = best;
+    planTick = t;
+    previous = { t, best[0], best_score };
+    return best[0];
+  }
+
+}
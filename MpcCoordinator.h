@@ -0,0 +1,62 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_MPCCOORDINATOR_H
+#define MISSIONAPP_MPCCOORDINATOR_H
+
+#include "RobustnessCoordinator.h"
+#include <vector>
+
+namespace cdra {
+
+    /**
+     * Receding-horizon (model predictive) coordination: resolves a conflict by
+     * optimizing a sequence of MPC_HORIZON actions, each held for one
+     * prediction step, against the properties' robustness over the predicted
+     * trajectory (see SequenceScorer), and performs the first action.
+     * The sequences are optimized by the cross-entropy method, starting from
+     * the plan of the previous tick shifted by one step (during a sustained
+     * conflict) and from holding each of the conflicting actions.
+     */
+    class MpcCoordinator : public RobustnessCoordinator {
+
+        // Latest optimized sequence, and the tick it was optimized at
+        std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> plan;
+        int planTick = -1;
+
+    protected:
+        dronecode_sdk::Offboard::VelocityNEDYaw synthesize(const std::vector<StlExpr*>& properties,
+                                                           const std::vector<float>& weights,
+                                                           const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                                                           int t);
+
+    public:
+        MpcCoordinator(std::shared_ptr<dronecode_sdk::Offboard> offboard,
+		       std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
+		       std::shared_ptr<StateStore> store);
+        ~MpcCoordinator();
+    };
+}
+
+#endif //MISSIONAPP_MPCCOORDINATOR_H
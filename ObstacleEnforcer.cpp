@@ -0,0 +1,128 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "ObstacleEnforcer.h"
+#include <iostream>
+#include <math.h>
+
+using namespace dronecode_sdk;
+using namespace std;
+
+namespace cdra {
+
+    ObstacleEnforcer::ObstacleEnforcer(std::shared_ptr<dronecode_sdk::Offboard> offboard,
+        std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
+        std::shared_ptr<StateStore> store) : StlEnforcer(offboard, telemetry, store) {
+        enforcerName = "Obstacle Enforcer";
+
+        obstacles = std::make_shared<KdTree>();
+        if (droneutil::OBSTACLE_FILE.empty() || !obstacles->load(droneutil::OBSTACLE_FILE))
+            throw "Obstacles unavailable!";
+
+	// Property: Current DTO is maintained above a safe threshold
+        obstacleFun = new ObstacleFun(obstacles, droneutil::OBSTACLE_SAFE_DISTANCE);
+
+	prop = new Prop(obstacleFun);
+    }
+
+    ObstacleEnforcer::~ObstacleEnforcer(){
+        delete obstacleFun;
+    }
+
+    std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
+            ObstacleEnforcer::actPropSatisfied(const dronecode_sdk::Offboard::VelocityNEDYaw &velocity_ned_yaw)  {
+        std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> newNEDs;
+        newNEDs.push_back(velocity_ned_yaw);
+        return newNEDs;
+    }
+
+    std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>
+            ObstacleEnforcer::actPropViolated(const dronecode_sdk::Offboard::VelocityNEDYaw &velocity_ned_yaw) {
+
+        /**
+         * Goal: Direct the drone in directions away from the nearest obstacle
+         */
+        Signal* signal = store->getSignal();
+
+        cout << endl;
+        cout << "*** Obstacle Enforcer: Property violated!" << endl;
+
+        float pos_north = signal->value("pos_north_m");
+        float pos_east  = signal->value("pos_east_m" );
+        float pos_down  = signal->value("pos_down_m" );
+        float dist;
+        const KdTree::Sphere& obstacle = obstacles->sphere(obstacles->nearest(pos_north, pos_east, pos_down, dist));
+
+	// Direction from the obstacle's center to the ego drone
+        float away[3] = {pos_north - obstacle.pos[0], pos_east - obstacle.pos[1], pos_down - obstacle.pos[2]};
+	if(!droneutil::EGO_Z_VELOCITY) { away[2] = 0; }
+        float norm = sqrt(away[0]*away[0] + away[1]*away[1] + away[2]*away[2]);
+        if (norm == 0) {
+            // Right above/below (or at) the center: back off from the current velocity
+            away[0] = -velocity_ned_yaw.north_m_s;
+            away[1] = -velocity_ned_yaw.east_m_s;
+            away[2] = droneutil::EGO_Z_VELOCITY ? -velocity_ned_yaw.down_m_s : 0;
+            norm = sqrt(away[0]*away[0] + away[1]*away[1] + away[2]*away[2]);
+            if (norm == 0) {
+                away[0] = 1;
+                norm = 1;
+            }
+        }
+
+	std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> newNEDs;
+        Offboard::VelocityNEDYaw awayNED {
+            away[0] / norm * droneutil::MAX_DRONE_SPEED,
+            away[1] / norm * droneutil::MAX_DRONE_SPEED,
+            away[2] / norm * droneutil::MAX_DRONE_SPEED,
+            velocity_ned_yaw.yaw_deg
+        };
+	cout << "Obstacle avoidance vector (" << awayNED.north_m_s << "," << awayNED.east_m_s << "," << awayNED.down_m_s << ")" << endl;
+        newNEDs.push_back(awayNED);
+
+	if(droneutil::SUGGEST_ACTION_RANGE) {
+	  /* Deviations from the avoidance vector that still move away from the obstacle */
+	  int num_intervals = 4;
+	  float step = droneutil::MAX_DRONE_SPEED*2/num_intervals;
+	  float max_k = droneutil::EGO_Z_VELOCITY ? droneutil::MAX_DRONE_SPEED : 0;
+	  for(float i = -droneutil::MAX_DRONE_SPEED; i <= droneutil::MAX_DRONE_SPEED; i += step) {
+	    for(float j = -droneutil::MAX_DRONE_SPEED; j <= droneutil::MAX_DRONE_SPEED; j += step) {
+	      for(float k = -max_k; k <= max_k; k += step) {
+		Offboard::VelocityNEDYaw curNED {
+		  i+awayNED.north_m_s,
+		    j+awayNED.east_m_s,
+		    k+awayNED.down_m_s,
+		    velocity_ned_yaw.yaw_deg
+		    };
+		if (curNED.north_m_s*away[0] + curNED.east_m_s*away[1] + curNED.down_m_s*away[2] <= 0)
+		  continue;
+		droneutil::scaleToMaxVelocity(curNED);
+		newNEDs.push_back(curNED);
+	      }
+	    }
+	  }
+	}
+        return newNEDs;
+    }
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "Signal.h"
+#include "ObstacleFun.h"
+#include "DroneUtil.h"
+#include <cmath>
+#include <iostream>
+
+namespace cdra {
+
+    ObstacleFun::ObstacleFun(std::shared_ptr<KdTree> obstacles, float safeDist) :
+        obstacles(obstacles), safeDist(safeDist)
+    {
+      /* What is the lowest possible robustness value (touching an obstacle) */
+      minValue = -safeDist;
+
+      /* What is the highest robustness value that we care about? */
+      /* i.e., robustness higher than this value doesn't matter */
+      maxValue = safeDist*2 - safeDist;
+
+      std::cout << "OMax: " << std::to_string(maxValue) <<  std::endl;
+      std::cout << "OMin: " << std::to_string(minValue) << std::endl;
+      std::cout << "OMid: " << std::to_string(-minValue / (maxValue - minValue)) << std::endl;
+    }
+
+    ObstacleFun::~ObstacleFun()
+    {
+    }
+
+    float ObstacleFun::value(Signal *sig, int t) {
+        float dto;
+        obstacles->nearest(sig->value("pos_north_m", t), sig->value("pos_east_m", t),
+                           sig->value("pos_down_m", t), dto);
+        return normalizeValue(dto - safeDist);
+    }
+
+    float ObstacleFun::value(Signal *sig) {
+        return value(sig, sig->length() - 1);
+    }
+
+    void ObstacleFun::valueBatch(const StateBatch& states, float* out) {
+        int n = states.size();
+        obstacles->nearest(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST),
+                           states.data(StateBatch::POS_DOWN), n, out);
+        for (int i = 0; i < n; i++) {
+            out[i] -= safeDist;
+        }
+        normalizeBatch(out, n);
+    }
+
+    bool ObstacleFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+        // The distance to a surface changes at most as much as the position
+        float center[3], radius = 0;
+        const StateBatch::Channel pos[3] = { StateBatch::POS_NORTH, StateBatch::POS_EAST, StateBatch::POS_DOWN };
+        for (int k = 0; k < 3; k++) {
+            float half = (bounds.upper[pos[k]] - bounds.lower[pos[k]]) / 2;
+            center[k] = bounds.lower[pos[k]] + half;
+            radius += half*half;
+        }
+        radius = sqrt(radius);
+        float dto;
+        if (obstacles->nearest(center[0], center[1], center[2], dto) < 0) {
+            normalizedRange(lower, upper);
+            return true;
+        }
+        lower = normalizeValue(dto - radius - safeDist);
+        upper = normalizeValue(dto + radius - safeDist);
+        return true;
+    }
+
+    bool ObstacleFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+        float pos_north_m = sig->value("pos_north_m", t);
+        float pos_east_m  = sig->value("pos_east_m" , t);
+        float pos_down_m  = sig->value("pos_down_m" , t);
+
+        // Only the obstacles the drone can get too close to within the horizon
+        std::vector<int> near;
+        obstacles->within(pos_north_m, pos_east_m, pos_down_m,
+                          droneutil::MAX_DRONE_SPEED*horizon + safeDist, near);
+        for (int i : near) {
+            const KdTree::Sphere& s = obstacles->sphere(i);
+            float d[3] = {pos_north_m - s.pos[0], pos_east_m - s.pos[1], pos_down_m - s.pos[2]};
+            float dist = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+            if (dist == 0) {
+                // No direction away from the obstacle to describe the region by
+                return false;
+            }
+            // As in DTTFun: keep to the half-space beyond the tangent plane of the
+            // inflated sphere facing the drone: (d + v*horizon) . u >= radius + safeDist
+            region.addHalfSpace(-d[0]/dist*horizon, -d[1]/dist*horizon, -d[2]/dist*horizon,
+                                dist - s.radius - safeDist);
+        }
+        return true;
+    }
+
+    bool ObstacleFun::prop(Signal *sig, int t) {
+        float val = value(sig, t);
+        return (val >= 0);
+    }
+
+    bool ObstacleFun::prop(Signal *sig) {
+        float val = value(sig);
+        return (val >= 0);
+    }
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_OBSTACLEFUN_H
+#define MISSIONAPP_OBSTACLEFUN_H
+
+#include "Signal.h"
+#include "SigFun.h"
+#include "KdTree.h"
+#include <memory>
+
+namespace cdra {
+
+    /**
+     * Distance to Obstacle (DTO) function
+     * A function that takes a signal as an input and computes the
+     * distance between the drone and the surface of the nearest static
+     * obstacle (see KdTree.h)
+     */
+    class ObstacleFun :  public SigFun {
+
+        std::shared_ptr<KdTree> obstacles;
+        const float safeDist;
+
+    public:
+        ObstacleFun(std::shared_ptr<KdTree> obstacles, float safeDist);
+        virtual ~ObstacleFun();
+        // returns the DTO at tick "t"
+        float value(Signal *sig, int t);
+        // returns the current DTO
+        float value(Signal *sig);
+        // returns true iff DTO at tick "t" within safe threshold
+        bool prop(Signal *sig, int t);
+        // returns true iff current DTO within safe threshold
+        bool prop(Signal *sig);
+        // returns the DTO for each state of the batch
+        void valueBatch(const StateBatch& states, float* out);
+        // returns the half-spaces of velocities that keep clear of the obstacles within reach (inner approximation)
+        bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+        // bounds the DTO from the center of the position box (the DTO is 1-Lipschitz)
+        bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
+        std::string propStr() { return "dist-to-obstacle - " + std::to_string(safeDist) +  " >= 0"; };
+	std::string enforcer_name() { return "Obstacle";};
+        const KdTree& getObstacles() const { return *obstacles; };
+    };
+
+}
+
+#endif //MISSIONAPP_OBSTACLEFUN_H
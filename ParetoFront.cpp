@@ -0,0 +1,241 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+
+#include "ParetoFront.h"
+#include "DroneUtil.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+
+namespace cdra {
+
+  /* Points (x, y, z) inserted one at a time, answering whether some point
+   * inserted so far is at least (a, b, c) in every coordinate: a Fenwick
+   * tree over the ranks of x (largest first), each node holding a Fenwick
+   * tree of the maximum z over the ranks of y of the points it may receive
+   * (known in advance). O(log^2 N) per operation. */
+  class DominanceTree {
+    std::vector<float> xs, ys;              // distinct values, largest first
+    std::vector<std::vector<int>> nodeYs;   // per node: ranks of y it may receive, ascending
+    std::vector<std::vector<float>> nodeMax;
+
+    static int rank(const std::vector<float>& values, float v) {
+      // (1-based, values >= v get ranks <= the returned one)
+      return std::lower_bound(values.begin(), values.end(), v, std::greater<float>()) - values.begin() + 1;
+    }
+
+  public:
+    // "points" holds the (x, y) of every point that may be inserted
+    DominanceTree(const std::vector<std::pair<float, float>>& points) {
+      for (auto& p : points) {
+	xs.push_back(p.first);
+	ys.push_back(p.second);
+      }
+      for (auto* values : { &xs, &ys }) {
+	std::sort(values->begin(), values->end(), std::greater<float>());
+	values->erase(std::unique(values->begin(), values->end()), values->end());
+      }
+      nodeYs.resize(xs.size() + 1);
+      for (auto& p : points) {
+	int y = rank(ys, p.second);
+	for (int x = rank(xs, p.first); x < (int)nodeYs.size(); x += x & -x) {
+	  nodeYs[x].push_back(y);
+	}
+      }
+      nodeMax.resize(nodeYs.size());
+      for (unsigned int x = 1; x < nodeYs.size(); x++) {
+	std::sort(nodeYs[x].begin(), nodeYs[x].end());
+	nodeYs[x].erase(std::unique(nodeYs[x].begin(), nodeYs[x].end()), nodeYs[x].end());
+	nodeMax[x].assign(nodeYs[x].size() + 1, -std::numeric_limits<float>::infinity());
+      }
+    }
+
+    void insert(float x, float y, float z) {
+      int ry = rank(ys, y);
+      for (int rx = rank(xs, x); rx < (int)nodeYs.size(); rx += rx & -rx) {
+	auto& node = nodeYs[rx];
+	auto& max = nodeMax[rx];
+	for (int i = std::lower_bound(node.begin(), node.end(), ry) - node.begin() + 1; i < (int)max.size(); i += i & -i) {
+	  max[i] = std::max(max[i], z);
+	}
+      }
+    }
+
+    bool dominated(float a, float b, float c) const {
+      // Points with x >= a are in the nodes of the prefix of its rank
+      int rx = std::upper_bound(xs.begin(), xs.end(), a, std::greater<float>()) - xs.begin();
+      int ry = std::upper_bound(ys.begin(), ys.end(), b, std::greater<float>()) - ys.begin();
+      for (; rx > 0; rx -= rx & -rx) {
+	auto& node = nodeYs[rx];
+	const auto& max = nodeMax[rx];
+	for (int i = std::upper_bound(node.begin(), node.end(), ry) - node.begin(); i > 0; i -= i & -i) {
+	  if (max[i] >= c) {
+	    return true;
+	  }
+	}
+      }
+      return false;
+    }
+  };
+
+  std::vector<int> paretoFront(const std::vector<float>& values, int num_objectives) {
+    const int d = num_objectives;
+    int n = d > 0 ? values.size() / d : 0;
+    const float* v = values.data();
+
+    // Lexicographically decreasing: only earlier candidates can dominate later ones,
+    // and equal candidates (which don't dominate each other) are adjacent
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [v, d](int i1, int i2) {
+	for (int k = 0; k < d; k++) {
+	  if (v[i1*d + k] != v[i2*d + k]) {
+	    return v[i1*d + k] > v[i2*d + k];
+	  }
+	}
+	return i1 < i2;
+      });
+    auto equal = [v, d](int i1, int i2) {
+      return std::equal(v + i1*d, v + (i1 + 1)*d, v + i2*d);
+    };
+
+    // Every candidate before a group of equal ones is lexicographically greater,
+    // so at least as good in the first objective: the group is dominated iff one
+    // of them is at least as good in the remaining objectives
+    std::vector<int> front;
+    float best = -std::numeric_limits<float>::infinity(); // 2 objectives: best second objective so far
+    std::map<float, float> stairs;                         // 3 objectives: non-dominated (2nd, 3rd) pairs so far
+    std::vector<std::pair<float, float>> points;
+    if (d == 4) {
+      for (int i = 0; i < n; i++) {
+	points.push_back({ v[i*d + 1], v[i*d + 2] });
+      }
+    }
+    DominanceTree tree(points);                            // 4 objectives: the last 3 of the front so far
+    for (int g = 0; g < n; ) {
+      int end = g + 1;
+      while (end < n && equal(order[g], order[end])) {
+	end++;
+      }
+      const float* row = v + order[g]*d;
+      bool dominated;
+      if (d == 1) {
+	dominated = g > 0;
+      } else if (d == 2) {
+	dominated = best >= row[1];
+	best = std::max(best, row[1]);
+      } else if (d == 3) {
+	// On the staircase, the 3rd objective decreases as the 2nd increases
+	auto it = stairs.lower_bound(row[1]);
+	dominated = it != stairs.end() && it->second >= row[2];
+	if (!dominated) {
+	  auto first = stairs.begin();
+	  auto last = stairs.upper_bound(row[1]);
+	  while (first != last && first->second > row[2]) {
+	    ++first;
+	  }
+	  // (the pairs from "first" on, up to row[1], are at most row[2])
+	  stairs.erase(first, last);
+	  stairs[row[1]] = row[2];
+	}
+      } else if (d == 4) {
+	dominated = tree.dominated(row[1], row[2], row[3]);
+	if (!dominated) {
+	  tree.insert(row[1], row[2], row[3]);
+	}
+      } else {
+	// A dominated candidate is also dominated by some candidate of the front
+	dominated = false;
+	for (int f = 0; f < (int)front.size() && !dominated; f++) {
+	  const float* other = v + front[f]*d;
+	  dominated = true;
+	  for (int k = 1; k < d; k++) {
+	    dominated = dominated && other[k] >= row[k];
+	  }
+	}
+      }
+      if (!dominated) {
+	for (int i = g; i < end; i++) {
+	  front.push_back(order[i]);
+	}
+      }
+      g = end;
+    }
+    std::sort(front.begin(), front.end());
+    return front;
+  }
+
+  int selectOnFront(const std::vector<float>& values, int num_objectives,
+		    const std::vector<int>& front, int rule, const std::vector<float>& weights) {
+    const int d = num_objectives;
+    auto weighted = [&](int i) {
+      float sum = 0;
+      for (int k = 0; k < d; k++) {
+	sum += weights[k] * values[i*d + k];
+      }
+      return sum;
+    };
+
+    // Ideal and worst values of each objective over the front
+    std::vector<float> ideal(d, -std::numeric_limits<float>::infinity());
+    std::vector<float> nadir(d, std::numeric_limits<float>::infinity());
+    for (int i : front) {
+      for (int k = 0; k < d; k++) {
+	ideal[k] = std::max(ideal[k], values[i*d + k]);
+	nadir[k] = std::min(nadir[k], values[i*d + k]);
+      }
+    }
+
+    int chosen = -1;
+    float best_key = 0, best_tie = 0;
+    for (int i : front) {
+      float key, tie = 0;
+      if (rule == droneutil::PARETO_MAXIMIN) {
+	key = *std::min_element(values.begin() + i*d, values.begin() + (i + 1)*d);
+	tie = weighted(i);
+      } else if (rule == droneutil::PARETO_IDEAL) {
+	key = 0;
+	for (int k = 0; k < d; k++) {
+	  float range = ideal[k] - nadir[k];
+	  float gap = range > 0 ? (ideal[k] - values[i*d + k]) / range : 0;
+	  key -= weights[k] * gap * gap;
+	}
+      } else {
+	key = weighted(i);
+      }
+      if (chosen < 0 || key > best_key || (key == best_key && tie > best_tie)) {
+	chosen = i;
+	best_key = key;
+	best_tie = tie;
+      }
+    }
+    return chosen;
+  }
+
+}
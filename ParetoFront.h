@@ -0,0 +1,63 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+
+#ifndef MISSIONAPP_PARETOFRONT_H
+#define MISSIONAPP_PARETOFRONT_H
+
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * Pareto front of candidates scored by several objectives (robustness
+   * values, all maximized), and selection of one candidate of the front.
+   * A candidate dominates another if it is no worse in every objective
+   * and better in at least one; the front is the set of the candidates no
+   * other candidate dominates.
+   *
+   * "values" holds a row of "num_objectives" values per candidate.
+   * The front is found by sorting the candidates lexicographically
+   * (O(N log N)) and sweeping them once, checking each against the front
+   * so far: in O(N) for 2 objectives, O(N log N) for 3 (a staircase of the
+   * best pairs of the last 2 objectives), O(N log^2 N) for 4 (a 2D
+   * Fenwick tree), and O(N F) for more, F being the size of the front.
+   */
+
+  // Indices (ascending) of the candidates on the front
+  std::vector<int> paretoFront(const std::vector<float>& values, int num_objectives);
+
+  // Index of the candidate of "front" chosen by "rule" (a value of
+  // PARETO_SELECTION, see DroneUtil.cpp), ties going to the lowest index:
+  //  - PARETO_WEIGHTED: the highest weighted sum of the objectives
+  //  - PARETO_MAXIMIN: the highest minimum objective (then weighted sum)
+  //  - PARETO_IDEAL: the closest to the front's ideal point (the best value
+  //    of each objective), by the weighted sum of squared distances
+  //    normalized by the front's range of each objective
+  int selectOnFront(const std::vector<float>& values, int num_objectives,
+		    const std::vector<int>& front, int rule, const std::vector<float>& weights);
+
+}
+
+#endif //MISSIONAPP_PARETOFRONT_H
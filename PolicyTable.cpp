@@ -0,0 +1,194 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "PolicyTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cdra {
+
+  static const char MAGIC[8] = {'C', 'D', 'R', 'A', 'P', 'L', 'C', 'Y'};
+
+  PolicyTable::PolicyTable() {
+    std::memset(&header, 0, sizeof(header));
+  }
+
+  PolicyTable::~PolicyTable() {
+    if (mapped) {
+      munmap(mapped, mappedSize);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  void PolicyTable::situation(Signal* signal, float state[AXES]) {
+    float pos[3] = { signal->value("pos_north_m"), signal->value("pos_east_m"), signal->value("pos_down_m") };
+    state[0] = pos[0];
+    state[1] = pos[1];
+    state[2] = pos[2];
+    state[3] = signal->value("vel_north_m_s");
+    state[4] = signal->value("vel_east_m_s");
+    state[5] = signal->value("vel_down_m_s");
+    state[6] = signal->value("enemy_pos_north_m") - pos[0];
+    state[7] = signal->value("enemy_pos_east_m") - pos[1];
+    state[8] = signal->value("enemy_pos_down_m") - pos[2];
+  }
+
+  bool PolicyTable::open(const std::string& fname) {
+    static_assert(sizeof(Header) == 160, "policy table header must be 160 bytes");
+    fd = ::open(fname.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+      std::cerr << "Cannot open policy table file: " << fname << std::endl;
+      return false;
+    }
+    bool valid = pread(fd, &header, sizeof(Header), 0) == (ssize_t)sizeof(Header) &&
+      std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == 1 &&
+      header.properties <= MAX_PROPERTIES;
+    size_t points = 1;
+    for (int a = AXES - 1; valid && a >= 0; a--) {
+      valid = header.counts[a] > 0 && (header.counts[a] == 1 || header.step[a] > 0);
+      strides[a] = points;
+      points *= header.counts[a];
+    }
+    if (!valid) {
+      std::cerr << "Bad policy table header: " << fname << std::endl;
+      return false;
+    }
+
+    mappedSize = sizeof(Header) + points * sizeof(Cell);
+    if ((size_t)st.st_size < mappedSize) {
+      std::cerr << "Truncated policy table file: " << fname << std::endl;
+      return false;
+    }
+
+    // Only map the file; cells are paged in when first looked up
+    mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      mapped = nullptr;
+      std::cerr << "Cannot map policy table file: " << fname << std::endl;
+      return false;
+    }
+    cells = (const Cell*)((const char*)mapped + sizeof(Header));
+
+    std::cout << "Policy table: " << points << " situations, " << header.properties << " properties" << std::endl;
+    return true;
+  }
+
+  bool PolicyTable::create(const std::string& fname, const std::vector<Cell>& cells,
+			   const unsigned int counts[AXES], const float origin[AXES], const float step[AXES],
+			   const std::vector<float>& weights) {
+    size_t points = 1;
+    for (int a = 0; a < AXES; a++) {
+      points *= counts[a];
+    }
+    if (points == 0 || cells.size() != points || weights.size() > MAX_PROPERTIES) {
+      return false;
+    }
+
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = 1;
+    h.properties = weights.size();
+    for (int a = 0; a < AXES; a++) {
+      h.counts[a] = counts[a];
+      h.origin[a] = origin[a];
+      h.step[a] = step[a];
+    }
+    for (unsigned int p = 0; p < weights.size(); p++) {
+      h.weights[p] = weights[p];
+    }
+
+    std::ofstream out(fname, std::ios::binary);
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)cells.data(), cells.size() * sizeof(Cell));
+    return (bool)out;
+  }
+
+  bool PolicyTable::lookup(const float state[AXES], uint32_t mask,
+			   dronecode_sdk::Offboard::VelocityNEDYaw& action) const {
+    if (!cells) {
+      return false;
+    }
+
+    // Lower grid point and weight of the upper one, per interpolated axis
+    size_t base = 0;
+    int axes[AXES], num_axes = 0;
+    float upper[AXES];
+    for (int a = 0; a < AXES; a++) {
+      if (header.counts[a] == 1) {
+	continue;
+      }
+      float f = (state[a] - header.origin[a]) / header.step[a];
+      if (!(f >= 0 && f <= header.counts[a] - 1)) {
+	return false;
+      }
+      int lower = std::min((int)f, (int)header.counts[a] - 2);
+      base += lower * strides[a];
+      axes[num_axes] = a;
+      upper[num_axes++] = f - lower;
+    }
+
+    // Points synthesized for other properties do not count
+    float sum[3] = {0, 0, 0}, total = 0;
+    for (unsigned int corner = 0; corner < (1u << num_axes); corner++) {
+      float w = 1;
+      size_t index = base;
+      for (int k = 0; k < num_axes; k++) {
+	if (corner & (1u << k)) {
+	  w *= upper[k];
+	  index += strides[axes[k]];
+	} else {
+	  w *= 1 - upper[k];
+	}
+      }
+      if (w == 0) {
+	continue;
+      }
+      const Cell& cell = cells[index];
+      if (cell.mask == mask) {
+	sum[0] += w * cell.north_m_s;
+	sum[1] += w * cell.east_m_s;
+	sum[2] += w * cell.down_m_s;
+	total += w;
+      }
+    }
+    if (total == 0) {
+      return false;
+    }
+    action = { sum[0] / total, sum[1] / total, sum[2] / total, 0 };
+    return true;
+  }
+
+}
@@ -0,0 +1,109 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_POLICYTABLE_H
+#define MISSIONAPP_POLICYTABLE_H
+
+#include <dronecode_sdk/offboard.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Signal.h"
+
+namespace cdra {
+
+  /**
+   * Actions synthesized offline (by policygen) over a grid of situations,
+   * memory-mapped from a binary file.
+   *
+   * A situation is the ego drone's position and velocity and the enemy's
+   * offset from it (north, east, down each), as for the DecisionCache;
+   * each grid point holds the action synthesized there for the properties
+   * then violated (a bit mask over the coordinator's enforcers, in their
+   * order). Lookups interpolate the actions of the grid points around a
+   * situation (multilinearly) that were synthesized for the same
+   * properties, reweighting them to sum to 1; an axis with a single point
+   * is not interpolated (the table assumes the action does not depend on
+   * it).
+   *
+   * File (little-endian): a 160-byte header
+   *   char[8] magic "CDRAPLCY", uint32 version (1), uint32 number of
+   *   properties (at most MAX_PROPERTIES), uint32 points per axis [9],
+   *   float first point per axis [9], float step per axis [9],
+   *   float weight per property [MAX_PROPERTIES], 4 reserved bytes
+   * followed by one Cell per grid point, row-major (the last axis varies
+   * fastest).
+   */
+  class PolicyTable {
+  public:
+    static const int AXES = 9;
+    static const int MAX_PROPERTIES = 8;
+
+    struct Cell {
+      float north_m_s, east_m_s, down_m_s;
+      uint32_t mask;  // properties the action was synthesized for (none if fewer than 2)
+    };
+
+  private:
+    struct Header {
+      char magic[8];
+      uint32_t version, properties, counts[AXES];
+      float origin[AXES], step[AXES], weights[MAX_PROPERTIES];
+      char reserved[4];
+    };
+
+    Header header;
+    int fd = -1;
+    void* mapped = nullptr;          // mapped file
+    const Cell* cells = nullptr;     // mapped grid points
+    size_t mappedSize = 0;
+    size_t strides[AXES];            // cells between consecutive points of each axis
+
+  public:
+    PolicyTable();
+    ~PolicyTable();
+    PolicyTable(const PolicyTable&) = delete;
+    PolicyTable& operator=(const PolicyTable&) = delete;
+
+    // Situation of the latest state of "signal"
+    static void situation(Signal* signal, float state[AXES]);
+
+    // Maps a policy table file; returns false on error
+    bool open(const std::string& fname);
+    // Writes a policy table file: "cells" holds one Cell per point of the grid
+    // given by "counts", "origin" and "step", and "weights" one per property
+    static bool create(const std::string& fname, const std::vector<Cell>& cells,
+		       const unsigned int counts[AXES], const float origin[AXES], const float step[AXES],
+		       const std::vector<float>& weights);
+
+    unsigned int numProperties() const { return header.properties; };
+    float weight(int property) const { return header.weights[property]; };
+    // Interpolated action of a situation for the properties in "mask"; false if the
+    // situation is outside the grid or no point around it was synthesized for them
+    bool lookup(const float state[AXES], uint32_t mask, dronecode_sdk::Offboard::VelocityNEDYaw& action) const;
+  };
+
+}
+
+#endif //MISSIONAPP_POLICYTABLE_H
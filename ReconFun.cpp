@@ -24,7 +24,9 @@
 
 #include "Signal.h"
 #include "ReconFun.h"
+#include "SigKernels.h"
 #include "DroneUtil.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -48,6 +50,19 @@ namespace cdra {
 		<< std::endl;
     }
 
+  ReconFun::ReconFun(std::shared_ptr<ZoneSet> zones) :
+    goal_z(0), acceptable_range(0), lowerx(0), lowery(0), upperx(0), uppery(0), zones(zones) {
+
+      /* DTE is relative to each zone's acceptable range (see computeZoneDTE) */
+      minValue = -1;
+      maxValue = 1;
+
+      std::cout << "EMax: " << std::to_string(maxValue) << std::endl;
+      std::cout << "EMin: " << std::to_string(minValue) << std::endl;
+      std::cout << "EMid: " << std::to_string(-minValue / (maxValue - minValue))
+		<< std::endl;
+    }
+
     ReconFun::~ReconFun() {
     }
 
@@ -63,9 +78,16 @@ namespace cdra {
     float pos_east_m  = sig->value("pos_east_m" , t);
     float pos_down_m  = sig->value("pos_down_m" , t);
     
+    if(zones) {
+      int zone = zones->find(pos_north_m, pos_east_m);
+      // Out of every zone gives 0 value (as below)
+      return zone < 0 ? 0 :
+	normalizeValue(computeZoneDTE(zones->zone(zone), elevation(pos_north_m, pos_east_m, pos_down_m)));
+    }
+    
     if(isInReconZone(pos_north_m, pos_east_m)) {
       // Pass in vertical position (note: down = -z)      
-      return normalizeValue(computeDTE(-pos_down_m));
+      return normalizeValue(computeDTE(elevation(pos_north_m, pos_east_m, pos_down_m)));
     } else {
       // If we're out of recon zone, give 0 value
       // NOTE/BEWARE: Weird interaction where you can improve robustness by avoiding recon zone
@@ -78,6 +100,123 @@ namespace cdra {
     return value(sig, sig->length() - 1);
   }
 
+  void ReconFun::valueBatch(const StateBatch& states, float* out) {
+    int n = states.size();
+    std::vector<float> in_zone(n);
+    const float* pos_down = states.data(StateBatch::POS_DOWN);
+    std::vector<float> above_terrain;
+    if(terrain) {
+      // Down position relative to the ground under each state
+      above_terrain.resize(n);
+      terrain->heights(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST),
+		       n, above_terrain.data());
+      for (int i = 0; i < n; i++) {
+	above_terrain[i] += pos_down[i];
+      }
+      pos_down = above_terrain.data();
+    }
+    if(zones) {
+      std::vector<int> zone(n);
+      zones->find(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST), n, zone.data());
+      for (int i = 0; i < n; i++) {
+	out[i] = zone[i] < 0 ? 0 : computeZoneDTE(zones->zone(zone[i]), -pos_down[i]);
+      }
+      normalizeBatch(out, n);
+      for (int i = 0; i < n; i++) {
+	out[i] = zone[i] < 0 ? 0 : out[i];
+      }
+      return;
+    }
+    kernels::dte(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST),
+		 pos_down, n, goal_z, acceptable_range,
+		 lowerx, lowery, upperx, uppery, out, in_zone.data());
+    normalizeBatch(out, n);
+    // Out of recon zone gives 0 value (see value())
+    for (int i = 0; i < n; i++) {
+      out[i] = in_zone[i] != 0 ? out[i] : 0;
+    }
+  }
+
+  bool ReconFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+    if(zones) {
+      // Zones may be anywhere: the whole range (with 0 out of every zone)
+      normalizedRange(lower, upper);
+      return true;
+    }
+    float min_north = bounds.lower[StateBatch::POS_NORTH], max_north = bounds.upper[StateBatch::POS_NORTH];
+    float min_east  = bounds.lower[StateBatch::POS_EAST] , max_east  = bounds.upper[StateBatch::POS_EAST];
+    bool inside  = min_north >= lowerx && max_north <= upperx && min_east >= lowery && max_east <= uppery;
+    bool outside = max_north < lowerx || min_north > upperx || max_east < lowery || min_east > uppery;
+    if(outside) {
+      lower = upper = 0;
+      return true;
+    }
+
+    // Elevation range (above the highest/lowest terrain within the box)
+    float low = 0, high = 0;
+    if(terrain) {
+      terrain->heightRange(min_north, min_east, max_north, max_east, low, high);
+    }
+    float min_z = -bounds.upper[StateBatch::POS_DOWN] - high;
+    float max_z = -bounds.lower[StateBatch::POS_DOWN] - low;
+    // The DTE is largest nearest to goal_z, and smallest at the farthest end
+    float nearest = goal_z < min_z ? min_z : (goal_z > max_z ? max_z : goal_z);
+    float farthest = fabsf(min_z - goal_z) > fabsf(max_z - goal_z) ? min_z : max_z;
+    lower = normalizeValue(computeDTE(farthest));
+    upper = normalizeValue(computeDTE(nearest));
+    if(!inside) {
+      // Partly out of the zone, where the value is 0
+      lower = std::min(lower, 0.0f);
+      upper = std::max(upper, 0.0f);
+    }
+    return true;
+  }
+
+  bool ReconFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+    float pos_north_m = sig->value("pos_north_m", t);
+    float pos_east_m  = sig->value("pos_east_m" , t);
+    float pos_down_m  = sig->value("pos_down_m" , t);
+
+    // Out of the recon zone(s) the proposition holds, so a zone only
+    // constrains the action if the drone can reach it within the horizon
+    float reach = droneutil::MAX_DRONE_SPEED * horizon;
+    std::vector<ZoneSet::Zone> reachable;
+    if (zones) {
+      std::vector<int> indices;
+      zones->overlapping(pos_north_m - reach, pos_east_m - reach,
+			 pos_north_m + reach, pos_east_m + reach, indices);
+      for (int i : indices) {
+	reachable.push_back(zones->zone(i));
+      }
+    } else {
+      float dx = std::max(std::max(lowerx - pos_north_m, pos_north_m - upperx), 0.0f);
+      float dy = std::max(std::max(lowery - pos_east_m , pos_east_m  - uppery), 0.0f);
+      if (sqrt(dx*dx + dy*dy) <= reach) {
+	reachable.push_back({lowerx, lowery, upperx, uppery, goal_z, acceptable_range});
+      }
+    }
+    if (reachable.empty()) {
+      return true;
+    }
+
+    // Ground altitudes within reach (flat ground at 0 without terrain)
+    float low = 0, high = 0;
+    if (terrain) {
+      terrain->heightRange(pos_north_m - reach, pos_east_m - reach,
+			   pos_north_m + reach, pos_east_m + reach, low, high);
+    }
+
+    // |-(pos_down + vel_down*horizon) - ground - goal_z| <= acceptable_range for any ground in [low, high]
+    // Note: these bands are sufficient but not necessary (the action might leave the zone)
+    float up_m = -pos_down_m;
+    for (auto& zone : reachable) {
+      region.addSlab(0, 0, horizon,
+		     up_m - zone.goal_z - zone.acceptable_range - low,
+		     up_m - zone.goal_z + zone.acceptable_range - high);
+    }
+    return true;
+  }
+
   float ReconFun::computeDTE(float ego_z) {
     const float delta = fabsf(ego_z - goal_z);
     
@@ -85,6 +224,15 @@ namespace cdra {
     return acceptable_range - delta; 
   }
        
+  float ReconFun::computeZoneDTE(const ZoneSet::Zone& zone, float ego_z) {
+    return (zone.acceptable_range - fabsf(ego_z - zone.goal_z)) / zone.acceptable_range;
+  }
+
+  float ReconFun::elevation(float north, float east, float down) {
+    // note: down = -z
+    return terrain ? -down - terrain->height(north, east) : -down;
+  }
+       
   bool ReconFun::prop(Signal *sig, int t) {
     float val = value(sig, t);
     return (val >= 0);
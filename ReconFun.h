@@ -27,6 +27,9 @@
 
 #include "Signal.h"
 #include "SigFun.h"
+#include "Heightmap.h"
+#include "ZoneSet.h"
+#include <memory>
 
 namespace cdra {
 
@@ -40,14 +43,24 @@ namespace cdra {
         const float goal_z;
 	const float acceptable_range;
 	const float lowerx, lowery, upperx, uppery;
+	std::shared_ptr<Heightmap> terrain; // if set, elevations are above the terrain
+	std::shared_ptr<ZoneSet> zones;     // if set, used instead of the single zone above
 	
         float computeDTE(float ego_z);
 	bool isInReconZone(float ego_x, float ego_y);
+	// DTE in a zone of the zone set, relative to the zone's acceptable range
+	static float computeZoneDTE(const ZoneSet::Zone& zone, float ego_z);
+	// Elevation of a position (above the terrain if set)
+	float elevation(float north, float east, float down);
 	
     public:
         ReconFun(float goal_z, float acceptable_range, float lowerx,
 		 float lowery, float upperx, float uppery);
+        // Multi-zone mode: each zone of the set has its own elevation band
+        ReconFun(std::shared_ptr<ZoneSet> zones);
         virtual ~ReconFun();
+        // Measure the elevation above the terrain instead of above the origin
+        void setTerrain(std::shared_ptr<Heightmap> terrain) { this->terrain = terrain; };
         // returns the DTE at tick "t"
         float value(Signal *sig, int t);
         // returns the current DTE
@@ -56,6 +69,12 @@ namespace cdra {
         bool prop(Signal *sig, int t);
         // returns true iff DTE at tick "t" is within acceptable_range
         bool prop(Signal *sig);
+        // returns the DTE for each state of the batch
+        void valueBatch(const StateBatch& states, float* out);
+        // returns the band of vertical velocities that reach the recon elevation
+        bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+        // bounds the DTE over the states within "bounds" (0 out of the zone)
+        bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
 	std::string enforcer_name() { return "Missile";};
         std::string propStr() { return "dist-to-elevation - " + std::to_string(acceptable_range) +  " >= 0"; };
     };
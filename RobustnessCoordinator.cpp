@@ -22,14 +22,22 @@
  * DM20-0762
  */
 
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
+#include <limits>
+#include <queue>
 #include <vector>
 #include <dronecode_sdk/offboard.h>
 #include <math.h>
-#include <random>
 #include <time.h>
 
 #include "RobustnessCoordinator.h"
+#include "ActionScorer.h"
+#include "ActionRegion.h"
+#include "CandidateGenerator.h"
+#include "LpSolver.h"
+#include "ParetoFront.h"
 #include "StlEnforcer.h"
 #include "DroneUtil.h"
 #include <iostream>
@@ -46,6 +54,16 @@ struct Pos3d {
   float z;
 };
 
+// Set while get_optimal_action synthesizes quietly on this thread
+static thread_local bool quiet_synthesis = false;
+
+/* Where synthesis logs: cout, or nowhere for quiet synthesis (whose lines would
+ * interleave with the tick log) */
+static ostream& synthesis_log() {
+  static thread_local ostream discard(nullptr);
+  return quiet_synthesis ? discard : cout;
+}
+
 /* Return the least different vector (using cosine similarity as measure of similarity) */
 Offboard::VelocityNEDYaw get_least_different(const Offboard::VelocityNEDYaw original,
 					     const vector<Offboard::VelocityNEDYaw>& candidates) {
@@ -64,146 +82,20 @@ Offboard::VelocityNEDYaw get_least_different(const Offboard::VelocityNEDYaw orig
   return argmax;
 }
 
-dronecode_sdk::Offboard::VelocityNEDYaw update_velocity(dronecode_sdk::Offboard::VelocityNEDYaw& old_v, dronecode_sdk::Offboard::VelocityNEDYaw& new_v, float num_steps) {
-  dronecode_sdk::Offboard::VelocityNEDYaw ret_v = old_v;
-  float td = droneutil::TICK_DURATION;
-  float est_acc = 2;
-
-  /* Determine if inc/decrease in velocity */
-  int x_dir = (new_v.north_m_s < old_v.north_m_s ? -1 : 1);
-  int y_dir = (new_v.east_m_s  < old_v.east_m_s  ? -1 : 1);
-  int z_dir = (new_v.down_m_s  < old_v.down_m_s  ? -1 : 1);
-
-  /* Figure out the max possible change given some acceleration */
-  ret_v.north_m_s += x_dir * est_acc * td * num_steps;
-  ret_v.east_m_s  += y_dir * est_acc * td * num_steps;
-  ret_v.down_m_s  += z_dir * est_acc * td * num_steps;
-
-  /* Velocity will be updated to the least extreme value 
-   * between max possible change and desired change */
-  ret_v.north_m_s = x_dir > 0 ?
-    min(ret_v.north_m_s, new_v.north_m_s) :
-    max(ret_v.north_m_s, new_v.north_m_s);
-  ret_v.east_m_s = y_dir > 0 ?
-    min(ret_v.east_m_s, new_v.east_m_s) :
-    max(ret_v.east_m_s, new_v.east_m_s);
-  ret_v.down_m_s = z_dir > 0 ?
-    min(ret_v.down_m_s, new_v.down_m_s) :
-    max(ret_v.down_m_s, new_v.down_m_s);
-  
-  return ret_v;
-}
-
-/*
- * Could get more accurate estimates if we update both drones together 
-std::Pair<dronecode_sdk::Telemetry::PositionVelocityNED, dronecode_sdk::Telemetry::PositionVelocityNED> update_both_drones(args) {
-
-}
-*/
-
-void get_est_signal(Signal* cur_signal,
-		    dronecode_sdk::Offboard::VelocityNEDYaw action,
-		    Signal* est_signal) {
-  // NOTE: Giving inaccurate position/velocity estimates for next state -- accuracy only really matters with respect to robustness relative to other potential actions. i.e., as long as this estimate roughly maintains the ordering of r(a_1') ... r(a_n') we're okay.
-
-  float td = droneutil::TICK_DURATION;
-
-  const float vel_east_m_s  = est_signal->value("vel_east_m_s");
-  const float vel_north_m_s = est_signal->value("vel_north_m_s");
-  const float vel_down_m_s  = est_signal->value("vel_down_m_s");
-
-  dronecode_sdk::Offboard::VelocityNEDYaw old_v;
+Offboard::VelocityNEDYaw get_action_in_range(pair<Offboard::VelocityNEDYaw, Offboard::VelocityNEDYaw>& vels,
+					     CandidateGenerator& generator) {
   
-  old_v.north_m_s = vel_north_m_s;
-  old_v.east_m_s  = vel_east_m_s;
-  old_v.down_m_s  = vel_down_m_s;
-
-  auto new_action = update_velocity(old_v, action, droneutil::TICKS_TO_CORRECT);
-
-  dronecode_sdk::Offboard::VelocityNEDYaw enemy_vel{
-      cur_signal->value("enemy_vel_east_m_s"),
-      cur_signal->value("enemy_vel_north_m_s"),
-      cur_signal->value("enemy_vel_down_m_s"),
-      0
-  };
-
-  /* Note: This estimate assumes that the new velocity is used immediately, 
-   * which is likely not the case, but should be an okay simple estimate. */
-  const float new_pos_east  = cur_signal->value("pos_east_m")  +
-    (((new_action.east_m_s))  * td * droneutil::TICKS_TO_CORRECT);
-  const float new_pos_north = cur_signal->value("pos_north_m") +
-    (((new_action.north_m_s)) * td * droneutil::TICKS_TO_CORRECT);
-  const float new_pos_down  = cur_signal->value("pos_down_m")  +
-    (((new_action.down_m_s))  * td * droneutil::TICKS_TO_CORRECT);
-
-  
-  int ticks_in_old_dir = 2;
-  
-  /* Enemy goes N ticks in the old direction */
-  float new_enemy_pos_east  = cur_signal->value("enemy_pos_east_m")  +
-    enemy_vel.east_m_s*td*ticks_in_old_dir;
-  float new_enemy_pos_north = cur_signal->value("enemy_pos_north_m") +
-    enemy_vel.north_m_s*td*ticks_in_old_dir;
-  float new_enemy_pos_down  = cur_signal->value("enemy_pos_down_m")  +
-    enemy_vel.down_m_s*td*ticks_in_old_dir;
-
-  /* NOTE: This makes 'side' moves less effective */
-  const float delta_east  = new_pos_east  - new_enemy_pos_east;
-  const float delta_north = new_pos_north - new_enemy_pos_north;
-  const float delta_down  = new_pos_down  - new_enemy_pos_down;
-  
-  const float delta = sqrt(pow(delta_east , 2.0) +
-			   pow(delta_north, 2.0) +
-			   pow(delta_down , 2.0));
-
-  const int enemy_speed = droneutil::ENEMY_DRONE_SPEED;
-
-  Offboard::VelocityNEDYaw attempted_enemy_vel{
-      enemy_speed*(delta_north/delta),
-      enemy_speed*(delta_east/delta),
-      enemy_speed*(delta_down/delta)
-      };
-  
-  auto new_enemy_action = update_velocity(enemy_vel, attempted_enemy_vel, droneutil::TICKS_TO_CORRECT-ticks_in_old_dir);
-  /* This will update the enemy position further -- Currently leaving the enemy position largely the same...
-  new_enemy_pos_east  +=
-    (((new_enemy_action.east_m_s))  * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
-  new_enemy_pos_north +=
-    (((new_enemy_action.north_m_s)) * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
-  new_enemy_pos_down  +=
-    (((new_enemy_action.down_m_s))  * td * (droneutil::TICKS_TO_CORRECT - ticks_in_old_dir));
-  */
-  est_signal->append({
-      new_pos_east, new_pos_north, new_pos_down,
-      new_action.east_m_s, new_action.north_m_s, new_action.down_m_s,
-      new_enemy_pos_east , new_enemy_pos_north , new_enemy_pos_down,
-      new_enemy_action.east_m_s, new_enemy_action.north_m_s,
-      new_enemy_action.down_m_s
-        }
-    );
-}
-
-Offboard::VelocityNEDYaw get_action_in_range(pair<Offboard::VelocityNEDYaw, Offboard::VelocityNEDYaw>& vels) {
-  
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  
-  std::uniform_real_distribution<float> dis_north(vels.first.north_m_s,
-						  vels.second.north_m_s);
-  std::uniform_real_distribution<float> dis_east (vels.first.east_m_s ,
-						  vels.second.east_m_s );
-  std::uniform_real_distribution<float> dis_down (vels.first.down_m_s ,
-						  vels.second.down_m_s );
+  // Map the next point of the unit cube onto the range
+  float u[3];
+  generator.next(u);
   /* Just choose within entire range
-  std::uniform_real_distribution<float> dis_north(-1, 1);
-  std::uniform_real_distribution<float> dis_east (-1, 1);
-  std::uniform_real_distribution<float> dis_down (-1, 1);
+  vels = { {-1, -1, -1}, {1, 1, 1} };
   */
   
   Offboard::VelocityNEDYaw ret {
-    dis_north(gen),
-    dis_east (gen),
-    dis_down (gen),
+    vels.first.north_m_s + u[0] * (vels.second.north_m_s - vels.first.north_m_s),
+    vels.first.east_m_s  + u[1] * (vels.second.east_m_s  - vels.first.east_m_s ),
+    vels.first.down_m_s  + u[2] * (vels.second.down_m_s  - vels.first.down_m_s ),
   };
 
   return ret;
@@ -236,16 +128,122 @@ Offboard::VelocityNEDYaw weightedMergeCommands(Offboard::VelocityNEDYaw& fst,
   return retNED;
 }
   
-vector<Offboard::VelocityNEDYaw> get_reasonable_actions(std::vector<Offboard::VelocityNEDYaw> base_actions) {
+/* Orthonormal basis (e1, e2) of the plane orthogonal to the unit direction "center" */
+void get_cap_basis(const Pos3d& center, Pos3d& e1, Pos3d& e2) {
+  Pos3d axis = fabsf(center.x) < 0.6f ? Pos3d { 1, 0, 0 } : Pos3d { 0, 1, 0 };
+  e1 = { center.y*axis.z - center.z*axis.y, center.z*axis.x - center.x*axis.z, center.x*axis.y - center.y*axis.x };
+  float e1_norm = sqrt(e1.x*e1.x + e1.y*e1.y + e1.z*e1.z);
+  e1 = { e1.x / e1_norm, e1.y / e1_norm, e1.z / e1_norm };
+  e2 = { center.y*e1.z - center.z*e1.y, center.z*e1.x - center.x*e1.z, center.x*e1.y - center.y*e1.x };
+}
+
+/* Samples max-speed actions with evenly spaced directions on the spherical cap around the
+ * unit direction "center" whose half-angle has cosine "cos_max"; on the arc of the horizontal
+ * circle around it without z velocity */
+vector<Offboard::VelocityNEDYaw> get_actions_on_cap(Pos3d center, float cos_max,
+						    CandidateGenerator& generator) {
+  vector<Offboard::VelocityNEDYaw> actions;
+  cos_max = max(cos_max, -1.0f);
+
+  /* Samples about 1/RANDOM_SEARCH_GRANULARITY apart (on the unit sphere) */
+  float precision = droneutil::RANDOM_SEARCH_GRANULARITY;
+  float u[3];
+  if(!droneutil::EGO_Z_VELOCITY) {
+    float half_angle = acos(cos_max);
+    float center_angle = atan2(center.y, center.x);
+    unsigned int num_actions = precision * 2 * half_angle;
+    for(unsigned int i = 0; i <= num_actions; i++) {
+      generator.next(u);
+      float angle = center_angle + (2*u[0] - 1) * half_angle;
+      actions.push_back({ droneutil::MAX_DRONE_SPEED * cos(angle), droneutil::MAX_DRONE_SPEED * sin(angle), 0 });
+    }
+    return actions;
+  }
+
+  Pos3d e1, e2;
+  get_cap_basis(center, e1, e2);
+
+  // Equal-area parameterization of the cap: uniform points of the
+  // square give evenly spaced directions
+  unsigned int num_actions = precision * precision * 2 * M_PI * (1 - cos_max);
+  for(unsigned int i = 0; i <= num_actions; i++) {
+    generator.next(u);
+    float cos_polar = 1 - u[0] * (1 - cos_max);
+    float sin_polar = sqrt(max(0.0f, 1 - cos_polar*cos_polar));
+    float azimuth = 2 * M_PI * u[1];
+    float a = sin_polar * cos(azimuth), b = sin_polar * sin(azimuth);
+    actions.push_back({
+	droneutil::MAX_DRONE_SPEED * (cos_polar * center.x + a * e1.x + b * e2.x),
+	droneutil::MAX_DRONE_SPEED * (cos_polar * center.y + a * e1.y + b * e2.y),
+	droneutil::MAX_DRONE_SPEED * (cos_polar * center.z + a * e1.z + b * e2.z) });
+  }
+  return actions;
+}
+
+/* Finds the spherical cap (around the mean direction) containing the directions of the
+ * conflicting actions: its unit center and the cosine of its half-angle; false if no
+ * action has a direction */
+bool get_conflict_cap(const std::vector<Offboard::VelocityNEDYaw>& base_actions,
+		      Pos3d& center, float& cos_max) {
+  // Unit directions of the conflicting actions, and their mean direction
+  vector<Pos3d> dirs;
+  center = { 0, 0, 0 };
+  for(auto& action : base_actions) {
+    Pos3d dir { action.north_m_s, action.east_m_s, droneutil::EGO_Z_VELOCITY ? action.down_m_s : 0 };
+    float norm = sqrt(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    if(norm == 0) { continue; }
+    dir = { dir.x / norm, dir.y / norm, dir.z / norm };
+    dirs.push_back(dir);
+    center = { center.x + dir.x, center.y + dir.y, center.z + dir.z };
+  }
+  if(dirs.empty()) {
+    return false;
+  }
+
+  // Cosine of the cap's half-angle
+  cos_max = 1;
+  float center_norm = sqrt(center.x*center.x + center.y*center.y + center.z*center.z);
+  if(center_norm < 1e-3) {
+    // Opposite directions: the whole sphere (circle)
+    center = dirs[0];
+    cos_max = -1;
+  } else {
+    center = { center.x / center_norm, center.y / center_norm, center.z / center_norm };
+    for(auto& dir : dirs) {
+      cos_max = min(cos_max, center.x*dir.x + center.y*dir.y + center.z*dir.z);
+    }
+  }
+  return true;
+}
+
+/* Samples max-speed actions with evenly spaced directions on a spherical cap (around the
+ * mean direction) containing the directions of the conflicting actions; on an arc of the
+ * horizontal circle without z velocity */
+vector<Offboard::VelocityNEDYaw> get_actions_on_sphere(const std::vector<Offboard::VelocityNEDYaw>& base_actions,
+						       CandidateGenerator& generator) {
+  Pos3d center;
+  float cos_max;
+  if(!get_conflict_cap(base_actions, center, cos_max)) {
+    return vector<Offboard::VelocityNEDYaw>();
+  }
+  return get_actions_on_cap(center, cos_max, generator);
+}
+
+vector<Offboard::VelocityNEDYaw> get_reasonable_actions(std::vector<Offboard::VelocityNEDYaw> base_actions,
+							 CandidateGenerator& generator) {
   // NOTE: this is PoC only -- should really MILP this stuff; for higher dimensions can just try random values?
   //  assert(base_actions.size() == 2);
     
   vector<Offboard::VelocityNEDYaw> reasonable_actions;
 
-  cout << "Starting actions: ";
+  synthesis_log() << "Starting actions: ";
   for (auto i = base_actions.begin(); i != base_actions.end(); ++i) {
     string s = "[" + to_string(i->north_m_s) + ", " + to_string(i->east_m_s) + ", " + to_string(i->down_m_s) + "]";
-    std::cout << s << endl;
+    synthesis_log() << s << endl;
+  }
+
+  if(droneutil::SAMPLE_ON_SPHERE) {
+    return get_actions_on_sphere(base_actions, generator);
   }
 
   /* Not necessary, but helps with rounding issues */
@@ -266,7 +264,7 @@ vector<Offboard::VelocityNEDYaw> get_reasonable_actions(std::vector<Offboard::Ve
   // Explore the space between the conflicting actions
   Offboard::VelocityNEDYaw new_action;
   for(unsigned long long i = 0; i <= num_actions; i++) {
-    new_action = get_action_in_range(action_range);
+    new_action = get_action_in_range(action_range, generator);
 
     droneutil::scaleToMaxVelocity(new_action);
 
@@ -285,82 +283,798 @@ vector<Offboard::VelocityNEDYaw> get_reasonable_actions(std::vector<Offboard::Ve
   return reasonable_actions;
 }
 
+/* Keeps the actions within the feasible region, plus (first) the feasible actions closest to each conflicting action */
+void filter_by_region(vector<Offboard::VelocityNEDYaw>& potential_actions,
+		      const vector<Offboard::VelocityNEDYaw>& conflicting_actions,
+		      const ActionRegion& region) {
+  vector<Offboard::VelocityNEDYaw> feasible;
+  Offboard::VelocityNEDYaw closest;
+  for(auto& action : conflicting_actions) {
+    if(region.closestPoint(action, droneutil::MAX_DRONE_SPEED, closest)) {
+      closest.yaw_deg = action.yaw_deg;
+      feasible.push_back(closest);
+    }
+  }
+  for(auto& action : potential_actions) {
+    if(region.contains(action)) {
+      feasible.push_back(action);
+    }
+  }
+
+  synthesis_log() << "Feasible actions: " << feasible.size() << " of " << potential_actions.size() << endl;
+  // If no action satisfies every property, score them all as before
+  if(!feasible.empty()) {
+    potential_actions = feasible;
+  }
+}
   
-/* Returns the optimal action */
+/* Cross-entropy method: refines a Gaussian over velocities (projected onto the
+ * max-speed sphere, as the sampled actions) toward the actions of highest weighted
+ * robustness, starting from the spread of the conflicting actions.
+ * Returns the best action evaluated; scores CEM_GENERATIONS * CEM_POPULATION
+ * synthesized actions plus the conflicting ones, or fewer if the deadline passes
+ * (checked between generations); "scored" is set to the number of scored actions and
+ * "robustness" to the weighted robustness of the returned one. */
+Offboard::VelocityNEDYaw get_cem_action(ActionScorer& scorer,
+					const vector<Offboard::VelocityNEDYaw>& conflicting_actions,
+					CandidateGenerator& generator,
+					std::chrono::steady_clock::time_point deadline,
+					unsigned int& scored, float& robustness) {
+  const float ELITE_FRACTION = 0.2;   // of each generation, used to refit the Gaussian
+  const float SMOOTHING      = 0.7;   // weight of the refit Gaussian (vs. the previous one)
+  const float MIN_STD        = 0.05 * droneutil::MAX_DRONE_SPEED;
+
+  int population = max(droneutil::CEM_POPULATION, 2u);
+  int num_elites = max((int)ceil(ELITE_FRACTION * population), 2);
+
+  // Initial Gaussian: mean and spread of the conflicting actions
+  float mean[3] = {0, 0, 0}, std_dev[3] = {0, 0, 0};
+  for(auto& action : conflicting_actions) {
+    mean[0] += action.north_m_s / conflicting_actions.size();
+    mean[1] += action.east_m_s  / conflicting_actions.size();
+    mean[2] += action.down_m_s  / conflicting_actions.size();
+  }
+  for(auto& action : conflicting_actions) {
+    float d[3] = { action.north_m_s - mean[0], action.east_m_s - mean[1], action.down_m_s - mean[2] };
+    for(int k = 0; k < 3; k++) { std_dev[k] += d[k]*d[k] / conflicting_actions.size(); }
+  }
+  for(int k = 0; k < 3; k++) { std_dev[k] = max((float)sqrt(std_dev[k]), MIN_STD); }
+  if(!droneutil::EGO_Z_VELOCITY) { mean[2] = std_dev[2] = 0; }
+
+  // The conflicting actions compete with the synthesized ones
+  vector<float> scores;
+  scorer.score(conflicting_actions, scores);
+  int argmax = max_element(scores.begin(), scores.end()) - scores.begin();
+  Offboard::VelocityNEDYaw best_action = conflicting_actions[argmax];
+  float best_score = scores[argmax];
+  scored = conflicting_actions.size();
+
+  vector<Offboard::VelocityNEDYaw> actions(population);
+  vector<int> order(population);
+  float z[3];
+  for(unsigned int gen = 0; gen < droneutil::CEM_GENERATIONS; gen++) {
+    if(std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    for(auto& action : actions) {
+      generator.nextNormal(z);
+      action = { mean[0] + std_dev[0]*z[0], mean[1] + std_dev[1]*z[1], mean[2] + std_dev[2]*z[2] };
+      if(droneutil::getMagnitude(action) == 0) { action.north_m_s = 1; }
+      droneutil::scaleToMaxVelocity(action);
+    }
+    scorer.score(actions, scores);
+    scored += population;
+
+    // Elites: the highest scores (ties broken by sample order, for determinism)
+    for(int i = 0; i < population; i++) { order[i] = i; }
+    partial_sort(order.begin(), order.begin() + num_elites, order.end(),
+		 [&scores](int i1, int i2) { return scores[i1] > scores[i2] || (scores[i1] == scores[i2] && i1 < i2); });
+    if(scores[order[0]] > best_score) {
+      best_score  = scores[order[0]];
+      best_action = actions[order[0]];
+    }
+
+    // Refit the Gaussian to the elites
+    float elite_mean[3] = {0, 0, 0}, elite_var[3] = {0, 0, 0};
+    for(int e = 0; e < num_elites; e++) {
+      auto& action = actions[order[e]];
+      elite_mean[0] += action.north_m_s / num_elites;
+      elite_mean[1] += action.east_m_s  / num_elites;
+      elite_mean[2] += action.down_m_s  / num_elites;
+    }
+    for(int e = 0; e < num_elites; e++) {
+      auto& action = actions[order[e]];
+      float d[3] = { action.north_m_s - elite_mean[0], action.east_m_s - elite_mean[1], action.down_m_s - elite_mean[2] };
+      for(int k = 0; k < 3; k++) { elite_var[k] += d[k]*d[k] / num_elites; }
+    }
+    for(int k = 0; k < 3; k++) {
+      mean[k]    = SMOOTHING * elite_mean[k] + (1 - SMOOTHING) * mean[k];
+      std_dev[k] = max(SMOOTHING * (float)sqrt(elite_var[k]) + (1 - SMOOTHING) * std_dev[k], MIN_STD);
+    }
+    if(!droneutil::EGO_Z_VELOCITY) { mean[2] = std_dev[2] = 0; }
+  }
+
+  synthesis_log() << "CEM best robustness: " << best_score << endl;
+  robustness = best_score;
+  return best_action;
+}
+
+/* Sequential linear programming: linearizes the robustness of each property around a
+ * velocity (first the current one) by forward differences, and solves for the velocity
+ * maximizing the weighted minimum of the linearized robustness values within the speed
+ * limit (an outer polyhedron of the max-speed sphere) and a trust box around the
+ * linearization point, halved on each of LP_ITERATIONS rounds (checking the deadline
+ * between rounds). The solutions, as is and scaled to max speed, are then verified with
+ * the exact robustness values, along with the conflicting actions; returns the one with
+ * the highest weighted minimum (then weighted sum, then the earliest).
+ * "scored" is set to the number of scored actions and "robustness" to the weighted
+ * robustness (sum) of the returned one. */
+Offboard::VelocityNEDYaw get_lp_action(const std::vector<StlExpr*>& properties,
+				       const std::vector<float>& weights,
+				       const vector<Offboard::VelocityNEDYaw>& conflicting_actions,
+				       Signal* signal, int t, const DroneModel& model, ThreadPool* pool,
+				       std::chrono::steady_clock::time_point deadline,
+				       unsigned int& scored, float& robustness) {
+  const float FD_STEP = 0.1; // m/s
+  const float max_speed = droneutil::MAX_DRONE_SPEED;
+  int num_axes = droneutil::EGO_Z_VELOCITY ? 3 : 2;
+  int num_props = properties.size();
+
+  // Robustness of each property alone
+  vector<std::unique_ptr<ActionScorer>> prop_scorers;
+  for(auto property : properties) {
+    prop_scorers.emplace_back(new ActionScorer({ property }, { 1 }, signal, t, model, pool));
+  }
+
+  // Speed limit: |v| <= max_speed along evenly spread directions
+  vector<Pos3d> speed_dirs;
+  for(int k = 0; k < 8; k++) {
+    float azimuth = k * M_PI / 4;
+    speed_dirs.push_back({ (float)cos(azimuth), (float)sin(azimuth), 0 });
+    if(droneutil::EGO_Z_VELOCITY) {
+      speed_dirs.push_back({ (float)(cos(azimuth) * M_SQRT1_2), (float)(sin(azimuth) * M_SQRT1_2), (float)M_SQRT1_2 });
+      speed_dirs.push_back({ (float)(cos(azimuth) * M_SQRT1_2), (float)(sin(azimuth) * M_SQRT1_2), (float)-M_SQRT1_2 });
+    }
+  }
+  if(droneutil::EGO_Z_VELOCITY) {
+    speed_dirs.push_back({ 0, 0, 1 });
+    speed_dirs.push_back({ 0, 0, -1 });
+  }
+
+  vector<Offboard::VelocityNEDYaw> candidates = conflicting_actions;
+  float v0[3] = { signal->value("vel_north_m_s"), signal->value("vel_east_m_s"),
+		  droneutil::EGO_Z_VELOCITY ? signal->value("vel_down_m_s") : 0 };
+  float radius = max_speed;
+  scored = 0;
+  vector<Offboard::VelocityNEDYaw> probes;
+  vector<float> values;
+  for(unsigned int round = 0; round < droneutil::LP_ITERATIONS; round++) {
+    if(round > 0 && std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+
+    // Linearize: robustness at v0, and along each axis
+    probes.assign(1, { v0[0], v0[1], v0[2], 0 });
+    for(int k = 0; k < num_axes; k++) {
+      float v[3] = { v0[0], v0[1], v0[2] };
+      v[k] += FD_STEP;
+      probes.push_back({ v[0], v[1], v[2], 0 });
+    }
+
+    // Variables: velocity (north, east, down) and the minimum margin
+    LpSolver lp(4);
+    for(int k = 0; k < 3; k++) {
+      if(k < num_axes) {
+	lp.setBounds(k, max(v0[k] - radius, -max_speed), min(v0[k] + radius, max_speed));
+      } else {
+	lp.setBounds(k, 0, 0);
+      }
+    }
+    lp.setObjective({ 0, 0, 0, 1 });
+    for(int p = 0; p < num_props; p++) {
+      prop_scorers[p]->score(probes, values);
+      scored += probes.size();
+      // margin <= w (r0 + g . (v - v0))
+      double g[3] = { 0, 0, 0 }, rhs = weights[p] * values[0];
+      for(int k = 0; k < num_axes; k++) {
+	g[k] = weights[p] * (values[k+1] - values[0]) / FD_STEP;
+	rhs -= g[k] * v0[k];
+      }
+      lp.addConstraint({ -g[0], -g[1], -g[2], 1 }, rhs);
+    }
+    for(auto& d : speed_dirs) {
+      lp.addConstraint({ d.x, d.y, d.z, 0 }, max_speed);
+    }
+
+    vector<double> x;
+    double margin;
+    if(lp.maximize(x, margin) != LpSolver::OPTIMAL) {
+      break;
+    }
+    Offboard::VelocityNEDYaw action { (float)x[0], (float)x[1], (float)x[2], 0 };
+    candidates.push_back(action);
+    if(droneutil::getMagnitude(action) > 0) {
+      droneutil::scaleToMaxVelocity(action);
+      candidates.push_back(action);
+    }
+    v0[0] = x[0]; v0[1] = x[1]; v0[2] = x[2];
+    radius /= 2;
+  }
+
+  // Verify against the exact robustness: best weighted minimum, then weighted sum
+  vector<float> min_rob(candidates.size(), 0), sum_rob(candidates.size(), 0);
+  for(int p = 0; p < num_props; p++) {
+    prop_scorers[p]->score(candidates, values);
+    scored += candidates.size();
+    for(unsigned int c = 0; c < candidates.size(); c++) {
+      min_rob[c] = p == 0 ? weights[p] * values[c] : min(min_rob[c], weights[p] * values[c]);
+      sum_rob[c] += weights[p] * values[c];
+    }
+  }
+  int argmax = 0;
+  for(unsigned int c = 1; c < candidates.size(); c++) {
+    if(min_rob[c] > min_rob[argmax] || (min_rob[c] == min_rob[argmax] && sum_rob[c] > sum_rob[argmax])) {
+      argmax = c;
+    }
+  }
+  synthesis_log() << "LP best weighted minimum robustness: " << min_rob[argmax] << endl;
+  robustness = sum_rob[argmax];
+  return candidates[argmax];
+}
+
+/* Actions with their weighted robustness, best first */
+typedef vector<pair<float, Offboard::VelocityNEDYaw>> RankedActions;
+
+/* Scores "actions" in chunks of "chunk_size", keeping the best one (the earliest on ties)
+ * in "best_action"/"best_score" ("found" tells whether there is one yet) and the best
+ * "top.size()" limit ones in "top"; stops at the deadline, checked between chunks once
+ * some action has been found. Actions that can make it into neither are only scored until
+ * that is known (see ActionScorer::score).
+ * Returns the number of scored actions. */
+unsigned int score_until_deadline(ActionScorer& scorer,
+				  const vector<Offboard::VelocityNEDYaw>& actions,
+				  unsigned int chunk_size,
+				  std::chrono::steady_clock::time_point deadline,
+				  Offboard::VelocityNEDYaw& best_action, float& best_score, bool& found,
+				  RankedActions& top, unsigned int top_size) {
+  vector<Offboard::VelocityNEDYaw> chunk;
+  vector<float> scores;
+  unsigned int scored = 0;
+  while(scored < actions.size()) {
+    if(found && std::chrono::steady_clock::now() >= deadline) {
+      synthesis_log() << "Synthesis deadline: scored " << scored << " of " << actions.size() << " actions" << endl;
+      break;
+    }
+    unsigned int end = min<size_t>(scored + chunk_size, actions.size());
+    chunk.assign(actions.begin() + scored, actions.begin() + end);
+    // Only actions above the worst kept one (or the best one, if none are kept) matter
+    float threshold = -numeric_limits<float>::infinity();
+    if(top_size > 0 && top.size() >= top_size) {
+      threshold = top.back().first;
+    } else if(top_size == 0 && found) {
+      threshold = best_score;
+    }
+    scorer.score(chunk, scores, threshold);
+
+    for(unsigned int i = 0; i < chunk.size(); i++) {
+      float cur_global_rob = scores[i];
+      /*
+      auto cur_action = chunk[i];
+      string s = "[" + to_string(cur_action.north_m_s) + ", " + to_string(cur_action.east_m_s) + ", " + to_string(cur_action.down_m_s) + "]";
+      std::cout << " R## " << s << " : " << to_string(cur_global_rob) << endl;
+      */
+
+      // Update values if new max
+      if(cur_global_rob > best_score || !found) {
+	best_score = cur_global_rob;
+	best_action = chunk[i];
+	found = true;
+      }
+      // Keep the top actions, after those of equal robustness
+      if(top_size > 0 && (top.size() < top_size || cur_global_rob > top.back().first)) {
+	auto pos = upper_bound(top.begin(), top.end(), cur_global_rob,
+			       [](float score, const pair<float, Offboard::VelocityNEDYaw>& ranked) { return score > ranked.first; });
+	top.insert(pos, { cur_global_rob, chunk[i] });
+	if(top.size() > top_size) { top.pop_back(); }
+      }
+    }
+    scored = end;
+  }
+  return scored;
+}
+
+/* Refines the "top" sampled actions by projected gradient ascent on the max-speed sphere
+ * (circle without z velocity): the gradient of the weighted robustness along the sphere is
+ * estimated by forward differences, and each action is rotated by "step" rad along it;
+ * a step that does not improve the action is halved instead. Runs REFINE_STEPS rounds,
+ * each scoring every action's differences and moves in one batch, checking the deadline
+ * between rounds. Keeps the best action found in "best_action"/"best_score".
+ * Returns the number of scored actions. */
+unsigned int refine_actions(ActionScorer& scorer, RankedActions& top,
+			    std::chrono::steady_clock::time_point deadline,
+			    Offboard::VelocityNEDYaw& best_action, float& best_score) {
+  const float FD_STEP = 0.01; // rad
+
+  // Unit directions and step of the actions being refined
+  vector<Pos3d> dirs;
+  vector<float> values, steps;
+  for(auto& ranked : top) {
+    auto& action = ranked.second;
+    Pos3d dir { action.north_m_s, action.east_m_s, droneutil::EGO_Z_VELOCITY ? action.down_m_s : 0 };
+    float norm = sqrt(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    if(norm == 0) { continue; }
+    dirs.push_back({ dir.x / norm, dir.y / norm, dir.z / norm });
+    values.push_back(ranked.first);
+    steps.push_back(1.0f / max(droneutil::RANDOM_SEARCH_GRANULARITY, 1u));
+  }
+  int n = dirs.size();
+  int num_axes = droneutil::EGO_Z_VELOCITY ? 2 : 1;
+  auto to_action = [](const Pos3d& dir) {
+    return Offboard::VelocityNEDYaw { droneutil::MAX_DRONE_SPEED * dir.x, droneutil::MAX_DRONE_SPEED * dir.y,
+	droneutil::MAX_DRONE_SPEED * dir.z, 0 };
+  };
+  // Direction "dir" rotated by "angle" toward the unit tangent "tangent"
+  auto rotate = [](const Pos3d& dir, const Pos3d& tangent, float angle) {
+    return Pos3d { dir.x * cos(angle) + tangent.x * sin(angle), dir.y * cos(angle) + tangent.y * sin(angle),
+	dir.z * cos(angle) + tangent.z * sin(angle) };
+  };
+
+  unsigned int scored = 0;
+  vector<Offboard::VelocityNEDYaw> actions;
+  vector<float> scores;
+  vector<Pos3d> axes(n * num_axes), moves(n);
+  for(unsigned int round = 0; round < droneutil::REFINE_STEPS && n > 0; round++) {
+    if(std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+
+    // Forward differences along an orthonormal basis of the tangent plane
+    actions.clear();
+    for(int i = 0; i < n; i++) {
+      Pos3d& d = dirs[i];
+      if(num_axes == 1) {
+	axes[i] = { -d.y, d.x, 0 };
+	float norm = sqrt(d.x*d.x + d.y*d.y);
+	axes[i] = { axes[i].x / norm, axes[i].y / norm, 0 };
+      } else {
+	Pos3d axis = fabsf(d.x) < 0.6f ? Pos3d { 1, 0, 0 } : Pos3d { 0, 1, 0 };
+	Pos3d e1 { d.y*axis.z - d.z*axis.y, d.z*axis.x - d.x*axis.z, d.x*axis.y - d.y*axis.x };
+	float e1_norm = sqrt(e1.x*e1.x + e1.y*e1.y + e1.z*e1.z);
+	e1 = { e1.x / e1_norm, e1.y / e1_norm, e1.z / e1_norm };
+	axes[2*i]     = e1;
+	axes[2*i + 1] = { d.y*e1.z - d.z*e1.y, d.z*e1.x - d.x*e1.z, d.x*e1.y - d.y*e1.x };
+      }
+      for(int a = 0; a < num_axes; a++) {
+	actions.push_back(to_action(rotate(d, axes[i*num_axes + a], FD_STEP)));
+      }
+    }
+    scorer.score(actions, scores);
+    scored += actions.size();
+
+    // Move each action along its gradient
+    for(int i = 0; i < n; i++) {
+      Pos3d g { 0, 0, 0 };
+      for(int a = 0; a < num_axes; a++) {
+	float slope = (scores[i*num_axes + a] - values[i]) / FD_STEP;
+	Pos3d& e = axes[i*num_axes + a];
+	g = { g.x + slope * e.x, g.y + slope * e.y, g.z + slope * e.z };
+      }
+      float g_norm = sqrt(g.x*g.x + g.y*g.y + g.z*g.z);
+      moves[i] = g_norm > 0 ? rotate(dirs[i], { g.x / g_norm, g.y / g_norm, g.z / g_norm }, steps[i]) : dirs[i];
+    }
+    actions.clear();
+    for(int i = 0; i < n; i++) {
+      actions.push_back(to_action(moves[i]));
+    }
+    scorer.score(actions, scores);
+    scored += actions.size();
+
+    for(int i = 0; i < n; i++) {
+      if(scores[i] > values[i]) {
+	dirs[i] = moves[i];
+	values[i] = scores[i];
+	if(scores[i] > best_score) {
+	  best_score = scores[i];
+	  best_action = actions[i];
+	}
+      } else {
+	steps[i] /= 2;
+      }
+    }
+  }
+  return scored;
+}
+
+/* Pareto selection (PARETO_SELECTION): scores the conflicting actions and the synthesized
+ * ones (those of the full sampling search -- the trust region and the refinement follow
+ * the weighted sum, so they are skipped) keeping the robustness of each property, in
+ * chunks of "chunk_size" until the deadline (checked between chunks, after the first).
+ * Returns the action that PARETO_SELECTION chooses on the Pareto front of the scored
+ * ones; "scored" is set to the number of scored actions, "front_size" to the size of the
+ * front and "robustness" to the weighted robustness of the returned action. */
+Offboard::VelocityNEDYaw get_pareto_action(ActionScorer& scorer,
+					   const std::vector<float>& weights,
+					   const vector<Offboard::VelocityNEDYaw>& conflicting_actions,
+					   CandidateGenerator& generator,
+					   unsigned int chunk_size,
+					   std::chrono::steady_clock::time_point deadline,
+					   unsigned int& scored, unsigned int& front_size, float& robustness) {
+  vector<Offboard::VelocityNEDYaw> potential_actions = conflicting_actions;
+  if(droneutil::SYNTHESIZE_ACTIONS) {
+    auto synthesized = get_reasonable_actions(conflicting_actions, generator);
+    potential_actions.insert(potential_actions.end(), synthesized.begin(), synthesized.end());
+  }
+
+  int num_props = scorer.numProperties();
+  vector<Offboard::VelocityNEDYaw> chunk;
+  vector<float> scores, values, chunk_scores, chunk_values;
+  scored = 0;
+  while(scored < potential_actions.size()) {
+    if(scored > 0 && std::chrono::steady_clock::now() >= deadline) {
+      synthesis_log() << "Synthesis deadline: scored " << scored << " of " << potential_actions.size() << " actions" << endl;
+      break;
+    }
+    unsigned int end = min<size_t>(scored + chunk_size, potential_actions.size());
+    chunk.assign(potential_actions.begin() + scored, potential_actions.begin() + end);
+    scorer.score(chunk, chunk_scores, chunk_values);
+    scores.insert(scores.end(), chunk_scores.begin(), chunk_scores.end());
+    values.insert(values.end(), chunk_values.begin(), chunk_values.end());
+    scored = end;
+  }
+
+  auto front = paretoFront(values, num_props);
+  int chosen = selectOnFront(values, num_props, front, droneutil::PARETO_SELECTION, weights);
+  synthesis_log() << "Pareto front: " << front.size() << " of " << scored << " actions" << endl;
+  front_size = front.size();
+  robustness = scores[chosen];
+  return potential_actions[chosen];
+}
+
+/* Range [lo, hi] of cos over the angles [a0, a1] */
+void get_cos_range(float a0, float a1, float& lo, float& hi) {
+  lo = min(cos(a0), cos(a1));
+  hi = max(cos(a0), cos(a1));
+  if(floor(a1 / (2*M_PI)) * 2*M_PI >= a0) { hi = 1; }
+  if(floor((a1 - M_PI) / (2*M_PI)) * 2*M_PI + M_PI >= a0) { lo = -1; }
+}
+
+/* A patch of the max-speed sphere: the directions at polar angles [polar0, polar1] from
+ * a cap's center and azimuths [azimuth0, azimuth1] around it; without z velocity, the arc
+ * of the horizontal circle at angles [azimuth0, azimuth1] (polar angles unused). "bound"
+ * is an upper bound on the weighted robustness of its actions */
+struct Patch {
+  float polar[2], azimuth[2];
+  float bound;
+  bool operator<(const Patch& other) const { return bound < other.bound; }
+};
+
+/* Spherical coordinates around a cap (see get_conflict_cap and get_cap_basis) */
+struct CapFrame {
+  Pos3d center, e1, e2;
+
+  Offboard::VelocityNEDYaw action(float polar, float azimuth) const {
+    const float speed = droneutil::MAX_DRONE_SPEED;
+    if(!droneutil::EGO_Z_VELOCITY) {
+      return { speed * (float)cos(azimuth), speed * (float)sin(azimuth), 0 };
+    }
+    float a = sin(polar) * cos(azimuth), b = sin(polar) * sin(azimuth), c = cos(polar);
+    return { speed * (c * center.x + a * e1.x + b * e2.x),
+	speed * (c * center.y + a * e1.y + b * e2.y),
+	speed * (c * center.z + a * e1.z + b * e2.z) };
+  }
+
+  /* Box of velocities containing the actions of "patch", by interval arithmetic on
+   * each component cos(polar) center + sin(polar) (cos(azimuth) e1 + sin(azimuth) e2) */
+  void box(const Patch& patch, Offboard::VelocityNEDYaw& lower, Offboard::VelocityNEDYaw& upper) const {
+    const float speed = droneutil::MAX_DRONE_SPEED;
+    const float PAD = 1e-5;  // for rounding, relative to the speed
+    float lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    if(!droneutil::EGO_Z_VELOCITY) {
+      get_cos_range(patch.azimuth[0], patch.azimuth[1], lo[0], hi[0]);
+      get_cos_range(patch.azimuth[0] - M_PI/2, patch.azimuth[1] - M_PI/2, lo[1], hi[1]);
+    } else {
+      float cos_lo = cos(patch.polar[1]), cos_hi = cos(patch.polar[0]), sin_lo, sin_hi;
+      get_cos_range(patch.polar[0] - M_PI/2, patch.polar[1] - M_PI/2, sin_lo, sin_hi);
+      float c[3] = { center.x, center.y, center.z }, u[3] = { e1.x, e1.y, e1.z }, v[3] = { e2.x, e2.y, e2.z };
+      for(int k = 0; k < 3; k++) {
+	// cos(azimuth) u + sin(azimuth) v = amplitude cos(azimuth - phase)
+	float amplitude = sqrt(u[k]*u[k] + v[k]*v[k]), phase = atan2(v[k], u[k]);
+	float wave_lo, wave_hi;
+	get_cos_range(patch.azimuth[0] - phase, patch.azimuth[1] - phase, wave_lo, wave_hi);
+	wave_lo *= amplitude;
+	wave_hi *= amplitude;
+	// (sin(polar) >= 0)
+	float ring_lo = min(sin_lo * wave_lo, sin_hi * wave_lo), ring_hi = max(sin_lo * wave_hi, sin_hi * wave_hi);
+	lo[k] = min(c[k] * cos_lo, c[k] * cos_hi) + ring_lo;
+	hi[k] = max(c[k] * cos_lo, c[k] * cos_hi) + ring_hi;
+      }
+    }
+    for(int k = 0; k < 3; k++) {
+      lo[k] = speed * (max(lo[k], -1.0f) - PAD);
+      hi[k] = speed * (min(hi[k], 1.0f) + PAD);
+    }
+    if(!droneutil::EGO_Z_VELOCITY) { lo[2] = hi[2] = 0; }
+    lower = { lo[0], lo[1], lo[2], 0 };
+    upper = { hi[0], hi[1], hi[2], 0 };
+  }
+
+  /* Splits "patch" in half across its longest side (as arcs on the unit sphere) */
+  void split(const Patch& patch, Patch& first, Patch& second) const {
+    first = second = patch;
+    bool along_azimuth = true;
+    if(droneutil::EGO_Z_VELOCITY) {
+      float sin_lo, sin_hi;
+      get_cos_range(patch.polar[0] - M_PI/2, patch.polar[1] - M_PI/2, sin_lo, sin_hi);
+      along_azimuth = (patch.azimuth[1] - patch.azimuth[0]) * sin_hi > patch.polar[1] - patch.polar[0];
+    }
+    float* range = along_azimuth ? first.azimuth : first.polar;
+    float middle = (range[0] + range[1]) / 2;
+    range[1] = middle;
+    (along_azimuth ? second.azimuth : second.polar)[0] = middle;
+  }
+};
+
+/* Branch and bound over the max-speed actions on the cap of the conflicting actions (see
+ * get_conflict_cap): the cap is recursively split into patches (see Patch), and each
+ * patch is bounded by ActionScorer::bounds over a box containing its actions; patches
+ * whose bound is at most BNB_TOLERANCE above the best action scored so far are pruned,
+ * and the others are split best bound first, their center actions scored. Patches are
+ * split "chunk_size" / 2 at a time (so that their children are scored in one batch)
+ * until none is left, BNB_MAX_EVALUATIONS actions are scored or the deadline passes
+ * (checked between batches, after the first).
+ * The conflicting actions compete with the synthesized ones. Returns false if the
+ * properties cannot be bounded (or there is no cap); otherwise sets "action" to the best
+ * action scored and "robustness" to its weighted robustness, "scored" to the number of
+ * scored actions, "regions" to the number of bounded patches, and "gap" to how much
+ * better than "action" the best remaining patch may be (0 once the search completed: no
+ * action on the cap is then more than BNB_TOLERANCE better). */
+bool get_bnb_action(ActionScorer& scorer,
+		    const vector<Offboard::VelocityNEDYaw>& conflicting_actions,
+		    unsigned int chunk_size,
+		    std::chrono::steady_clock::time_point deadline,
+		    Offboard::VelocityNEDYaw& action,
+		    unsigned int& scored, unsigned int& regions, float& gap, float& robustness) {
+  CapFrame frame;
+  float cos_max;
+  if(!get_conflict_cap(conflicting_actions, frame.center, cos_max)) {
+    return false;
+  }
+  Patch root;
+  float half_angle = acos(max(cos_max, -1.0f));
+  if(droneutil::EGO_Z_VELOCITY) {
+    get_cap_basis(frame.center, frame.e1, frame.e2);
+    root = { { 0, half_angle }, { 0, (float)(2*M_PI) }, 0 };
+  } else {
+    float center_angle = atan2(frame.center.y, frame.center.x);
+    root = { { 0, 0 }, { center_angle - half_angle, center_angle + half_angle }, 0 };
+  }
+  Offboard::VelocityNEDYaw lower, upper;
+  float lo;
+  frame.box(root, lower, upper);
+  if(!scorer.bounds(lower, upper, lo, root.bound)) {
+    return false;
+  }
+  regions = 1;
+
+  // The conflicting actions and the cap's center set the first incumbent
+  vector<Offboard::VelocityNEDYaw> actions = conflicting_actions;
+  actions.push_back(frame.action((root.polar[0] + root.polar[1]) / 2, (root.azimuth[0] + root.azimuth[1]) / 2));
+  vector<float> scores;
+  scorer.score(actions, scores);
+  scored = actions.size();
+  int argmax = max_element(scores.begin(), scores.end()) - scores.begin();
+  action = actions[argmax];
+  robustness = scores[argmax];
+
+  const float tolerance = droneutil::BNB_TOLERANCE;
+  unsigned int batch_size = max(chunk_size / 2, 1u);
+  priority_queue<Patch> patches;
+  patches.push(root);
+  vector<Patch> children;
+  for(int round = 0; !patches.empty() && patches.top().bound > robustness + tolerance; round++) {
+    if(scored >= droneutil::BNB_MAX_EVALUATIONS || (round > 0 && std::chrono::steady_clock::now() >= deadline)) {
+      break;
+    }
+    // Split the most promising patches, keeping the children that may beat the best action
+    children.clear();
+    actions.clear();
+    while(children.size() < 2 * batch_size && !patches.empty() && patches.top().bound > robustness + tolerance) {
+      Patch halves[2];
+      frame.split(patches.top(), halves[0], halves[1]);
+      patches.pop();
+      for(auto& child : halves) {
+	frame.box(child, lower, upper);
+	scorer.bounds(lower, upper, lo, child.bound);
+	regions++;
+	if(child.bound > robustness + tolerance) {
+	  children.push_back(child);
+	  actions.push_back(frame.action((child.polar[0] + child.polar[1]) / 2,
+					 (child.azimuth[0] + child.azimuth[1]) / 2));
+	}
+      }
+    }
+    scorer.score(actions, scores, robustness);
+    scored += actions.size();
+    for(unsigned int i = 0; i < actions.size(); i++) {
+      if(scores[i] > robustness) {
+	robustness = scores[i];
+	action = actions[i];
+      }
+    }
+    for(auto& child : children) {
+      if(child.bound > robustness + tolerance) {
+	patches.push(child);
+      }
+    }
+  }
+  gap = patches.empty() ? 0 : max(patches.top().bound - robustness, 0.0f);
+  synthesis_log() << "Branch and bound best robustness: " << robustness << " (gap " << gap << ", " << regions
+		  << " regions)" << endl;
+  return true;
+}
+
+/* Returns the optimal action found by the deadline, and sets "robustness" to its weighted
+ * robustness.
+ * Candidates are scored best-first (the conflicting actions, then the synthesized ones
+ * in generation order, whose every prefix covers the action range evenly) in chunks of
+ * DEADLINE_CHUNK per worker of "pool" (if any), checking the deadline between chunks;
+ * the first chunk is always scored. Ties go to the earliest candidate, so the result
+ * does not depend on the number of workers.
+ * Given the previous tick's decision ("warm_start"), the synthesized candidates are first
+ * drawn from a trust region around it, a cap of TRUST_REGION_ANGLE, doubled while the best
+ * robustness found stays TRUST_REGION_MARGIN below the previous one; once it would be as
+ * large as the full search (the cap of the conflicting actions, a quarter sphere for box
+ * sampling), the whole range is searched as without warm start.
+ * The REFINE_TOP_K best sampled actions are then refined (see refine_actions). */
 Offboard::VelocityNEDYaw get_optimal_action(const std::vector<StlExpr*>& properties,
 					    const std::vector<float>& weights,
 					    const std::vector<Offboard::VelocityNEDYaw>& conflicting_actions,
 					    std::shared_ptr<StateStore> store,
-					    int t) {
+					    int t,
+					    const DroneModel& model,
+					    CandidateGenerator& generator,
+					    std::chrono::steady_clock::time_point deadline,
+					    ThreadPool* pool,
+					    const RobustnessCoordinator::Decision* warm_start,
+					    float& robustness,
+					    bool quiet) {
   assert(properties.size() == weights.size() && properties.size());
+  struct QuietScope {
+    bool was;
+    QuietScope(bool quiet) : was(quiet_synthesis) { quiet_synthesis = quiet; }
+    ~QuietScope() { quiet_synthesis = was; }
+  } quiet_scope(quiet);
+  auto record = [&](const string& name, float value) {
+    if(!quiet) {
+      store->recordStat(name, value);
+    }
+  };
+  const unsigned int DEADLINE_CHUNK = 32;
+  unsigned int chunk_size = DEADLINE_CHUNK * (pool ? pool->size() : 1);
+  auto start_time = std::chrono::steady_clock::now();
 
-  vector<Offboard::VelocityNEDYaw> potential_actions;
+  synthesis_log() << "-------------------------------Robustness: " << endl;
+  ActionScorer scorer(properties, weights, store->getSignal(), t, model, pool);
 
-  // Just use conflicted actions if we're not synthesizing
-  if(droneutil::SYNTHESIZE_ACTIONS) {
-    potential_actions = get_reasonable_actions(conflicting_actions);    
-    // Concatenate enforcer conflicted actions to proposed actions
-    potential_actions.insert(potential_actions.end(), conflicting_actions.begin(), conflicting_actions.end());
-  } else {
-    potential_actions = conflicting_actions;
+  if(droneutil::SYNTHESIZE_ACTIONS && droneutil::SYNTHESIS_METHOD == droneutil::SYNTHESIS_CEM) {
+    unsigned int scored;
+    auto action = get_cem_action(scorer, conflicting_actions, generator, deadline, scored, robustness);
+    record("candidates_scored", scored);
+    record("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+    return action;
+  }
+  if(droneutil::SYNTHESIZE_ACTIONS && droneutil::SYNTHESIS_METHOD == droneutil::SYNTHESIS_LP) {
+    unsigned int scored;
+    auto action = get_lp_action(properties, weights, conflicting_actions, store->getSignal(), t, model, pool,
+				deadline, scored, robustness);
+    record("candidates_scored", scored);
+    record("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+    return action;
+  }
+  if(droneutil::SYNTHESIZE_ACTIONS && droneutil::SYNTHESIS_METHOD == droneutil::SYNTHESIS_BNB) {
+    unsigned int scored, regions;
+    float gap;
+    Offboard::VelocityNEDYaw action;
+    if(get_bnb_action(scorer, conflicting_actions, chunk_size, deadline, action, scored, regions, gap, robustness)) {
+      record("candidates_scored", scored);
+      record("bnb_regions", regions);
+      record("bnb_gap", gap);
+      record("property_evaluations", scorer.evaluations());
+      record("pruned_evaluations", scorer.prunedEvaluations());
+      record("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+      return action;
+    }
+    // Otherwise sample as usual
+  }
+  if(droneutil::SYNTHESIS_METHOD == droneutil::SYNTHESIS_SAMPLING && droneutil::PARETO_SELECTION != droneutil::PARETO_OFF) {
+    unsigned int scored, front_size;
+    auto action = get_pareto_action(scorer, weights, conflicting_actions, generator, chunk_size, deadline,
+				    scored, front_size, robustness);
+    record("candidates_scored", scored);
+    record("pareto_front", front_size);
+    record("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+    return action;
   }
 
-  double max_global_rob = 0;
+  float max_global_rob = 0;
   Offboard::VelocityNEDYaw max_action;
-  bool is_first = true;
-  
-  cout << "-------------------------------Robustness: " << endl;
-  Signal est_signal = *store->getSignal();
-  
-  for(auto cur_action : potential_actions) {
-    float cur_global_rob = 0;
-    
-    // Sum weighted robustness values for each property at time `t+1`
-    // Time t+1 because that includes the estimated signal
-    for(int i = 0; i < properties.size(); i++) {
-      get_est_signal(store->getSignal(), cur_action, &est_signal);
-      float robustness = properties[i]->robustness(&est_signal, t+1);
-      // We want to reuse our est_signal, so we have to pop off the last element
-      est_signal.pop();
-      
-      cur_global_rob += weights[i] * robustness;
+  bool found = false;
+  unsigned int scored = 0, total = 0;
+  RankedActions top; // sampled actions to refine
 
-      /*
-      string action_str = "[" + to_string(cur_action.north_m_s) + ", " + to_string(cur_action.east_m_s) + ", " + to_string(cur_action.down_m_s) + "]";
-      cout << action_str << ": R## "<< to_string(weights[i]) << " * " << to_string(robustness) << endl;
-      
-      cout << "Estimated signal: " << to_string(new_pos_north) << ", " << to_string(new_pos_east) << ", " << to_string(new_pos_down) << ", [";
-      cout <<  to_string(action.north_m_s) << ", " <<  to_string(action.east_m_s) << ", " << to_string(action.down_m_s) << "]" << endl;
-      
-      std::cout << "Est signal (part 2): " <<
-      est_signal.value("pos_north_m") << "," <<
-      est_signal.value("pos_east_m") << "," <<
-      est_signal.value("pos_down_m") << ",[" <<
-      est_signal.value("vel_north_m_s") << "," <<
-      est_signal.value("vel_east_m_s") << "," <<
-      est_signal.value("vel_down_m_s") << "]" << std::endl <<
-      "Enemey: " <<
-      est_signal.value("enemy_pos_north_m") << "," <<
-      est_signal.value("enemy_pos_east_m") << "," <<
-      est_signal.value("enemy_pos_down_m") << ",[" <<
-      est_signal.value("enemy_vel_north_m_s") << "," <<
-      est_signal.value("enemy_vel_east_m_s") << "," <<
-      est_signal.value("enemy_vel_down_m_s") << "]" << std::endl;
-      */
+  // Prefer actions that satisfy every property, if their region is known
+  ActionRegion region;
+  bool use_region = droneutil::FEASIBLE_REGION_FILTER && scorer.feasibleRegion(region) && !region.isEmpty();
+
+  // Trust region around the previous decision
+  bool trusted = false;
+  if(droneutil::SYNTHESIZE_ACTIONS && warm_start && droneutil::TRUST_REGION_ANGLE > 0) {
+    const auto& previous = warm_start->action;
+    Pos3d center { previous.north_m_s, previous.east_m_s, droneutil::EGO_Z_VELOCITY ? previous.down_m_s : 0 };
+    float norm = sqrt(center.x*center.x + center.y*center.y + center.z*center.z);
+    if(norm > 0) { center = { center.x / norm, center.y / norm, center.z / norm }; }
+    // Widen up to the size of the full search (the cap of the conflicting actions)
+    Pos3d conflict_center;
+    float cos_conflict = -1;
+    get_conflict_cap(conflicting_actions, conflict_center, cos_conflict);
+    float max_angle = droneutil::SAMPLE_ON_SPHERE ? acos(max(cos_conflict, -1.0f)) : M_PI / 2;
+    for(float angle = droneutil::TRUST_REGION_ANGLE; norm > 0 && angle < max_angle; angle *= 2) {
+      vector<Offboard::VelocityNEDYaw> potential_actions;
+      if(!found) {
+	potential_actions = conflicting_actions;
+	potential_actions.push_back(previous);
+      }
+      auto synthesized = get_actions_on_cap(center, cos(angle), generator);
+      potential_actions.insert(potential_actions.end(), synthesized.begin(), synthesized.end());
+      if(use_region) {
+	filter_by_region(potential_actions, conflicting_actions, region);
+      }
+      scored += score_until_deadline(scorer, potential_actions, chunk_size, deadline, max_action, max_global_rob, found,
+				     top, droneutil::REFINE_TOP_K);
+      total += potential_actions.size();
+
+      if(max_global_rob >= warm_start->robustness - droneutil::TRUST_REGION_MARGIN) {
+	synthesis_log() << "Trust region: " << angle << " rad" << endl;
+	trusted = true;
+	break;
+      }
+      if(std::chrono::steady_clock::now() >= deadline) {
+	break;
+      }
     }
-    /*
-    string s = "[" + to_string(cur_action.north_m_s) + ", " + to_string(cur_action.east_m_s) + ", " + to_string(cur_action.down_m_s) + "]";
-    std::cout << " R## " << s << " : " << to_string(cur_global_rob) << endl;
-    */
-    
-    // Update values if new max
-    if(cur_global_rob > max_global_rob || is_first) {
-      max_global_rob = cur_global_rob;
-      max_action = cur_action;
-      is_first = false;
+  }
+
+  if(!trusted) {
+    // Enforcer conflicted actions first, then the proposed ones (if we're synthesizing)
+    vector<Offboard::VelocityNEDYaw> potential_actions = conflicting_actions;
+    if(droneutil::SYNTHESIZE_ACTIONS) {
+      auto synthesized = get_reasonable_actions(conflicting_actions, generator);
+      potential_actions.insert(potential_actions.end(), synthesized.begin(), synthesized.end());
     }
+    if(use_region) {
+      filter_by_region(potential_actions, conflicting_actions, region);
+    }
+    scored += score_until_deadline(scorer, potential_actions, chunk_size, deadline, max_action, max_global_rob, found,
+				     top, droneutil::REFINE_TOP_K);
+    total += potential_actions.size();
   }
 
+  // Refine the best sampled actions beyond the sampling resolution
+  if(droneutil::SYNTHESIZE_ACTIONS && !top.empty()) {
+    float sampled_rob = max_global_rob;
+    unsigned int refined = refine_actions(scorer, top, deadline, max_action, max_global_rob);
+    scored += refined;
+    total += refined;
+    record("refine_gain", max_global_rob - sampled_rob);
+  }
+
+  record("candidates_scored", scored);
+  record("candidates_total", total);
+  record("trust_region", trusted);
+  record("property_evaluations", scorer.evaluations());
+  record("pruned_evaluations", scorer.prunedEvaluations());
+  record("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+  robustness = max_global_rob;
   return max_action;
 }
 
@@ -370,7 +1084,30 @@ namespace cdra {
 					       std::shared_ptr<dronecode_sdk::Offboard> offboard,
 					       std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
 					       std::shared_ptr<StateStore> store)
-    : Coordinator(offboard, telemetry, store) {}
+    : Coordinator(offboard, telemetry, store),
+      generator(CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED)),
+      model(DroneModel::create(droneutil::DRONE_MODEL)) {
+    int threads = droneutil::SYNTHESIS_THREADS;
+    if(threads == 0) {
+      threads = max(std::thread::hardware_concurrency(), 1u);
+    }
+    if(threads > 1) {
+      pool.reset(new ThreadPool(threads));
+    }
+    if(droneutil::DECISION_CACHE) {
+      cache.reset(new DecisionCache(droneutil::DECISION_CACHE_SIZE, droneutil::CACHE_POSITION_STEP,
+				    droneutil::CACHE_VELOCITY_STEP));
+    }
+    if(!droneutil::POLICY_TABLE_FILE.empty()) {
+      policy.reset(new PolicyTable());
+      if(!policy->open(droneutil::POLICY_TABLE_FILE)) {
+	throw "Policy table unavailable!";
+      }
+    }
+    if(droneutil::SPECULATIVE_SYNTHESIS) {
+      speculator.reset(new Speculator(*model));
+    }
+  }
 
   RobustnessCoordinator::~RobustnessCoordinator() {}
 
@@ -378,6 +1115,137 @@ namespace cdra {
     Coordinator::addEnforcer(e);
     StlEnforcer* se = (StlEnforcer*)e.get();
     weights.insert({se, weight});
+    if(speculator) {
+      speculator->addProperty(se->getProp(), weight);
+    }
+  }
+
+  std::chrono::steady_clock::time_point RobustnessCoordinator::synthesisDeadline() {
+    return droneutil::SYNTHESIS_DEADLINE ? store->deadline() : std::chrono::steady_clock::time_point::max();
+  }
+
+  bool RobustnessCoordinator::validates(const Offboard::VelocityNEDYaw& action,
+				      const vector<StlExpr*>& properties,
+				      const vector<float>& prop_weights,
+				      const vector<Offboard::VelocityNEDYaw>& actions,
+				      int t, float& robustness) {
+    ActionScorer scorer(properties, prop_weights, store->getSignal(), t, *model);
+    vector<Offboard::VelocityNEDYaw> candidates { action };
+    candidates.insert(candidates.end(), actions.begin(), actions.end());
+    vector<float> scores;
+    scorer.score(candidates, scores);
+    robustness = scores[0];
+    for(unsigned int i = 1; i < scores.size(); i++) {
+      if(scores[0] < scores[i]) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  Offboard::VelocityNEDYaw RobustnessCoordinator::synthesize(const vector<StlExpr*>& properties,
+							     const vector<float>& prop_weights,
+							     const vector<Offboard::VelocityNEDYaw>& actions,
+							     int t) {
+    auto start_time = std::chrono::steady_clock::now();
+    if(speculator) {
+      // Resolved during the previous tick's slack, for a predicted situation close to this
+      // one: use it unless a proposed action beats it here
+      float state[PolicyTable::AXES];
+      PolicyTable::situation(store->getSignal(), state);
+      Speculator::Speculation speculation;
+      if(speculator->find(t, properties, state, speculation)) {
+	float robustness;
+	if(validates(speculation.action, properties, prop_weights, actions, t, robustness)) {
+	  speculationHits++;
+	  cout << "Speculation hit: robustness " << robustness << " (predicted " << speculation.robustness << ")" << endl;
+	  store->recordStat("speculation_hit", 1);
+	  store->recordStat("speculation_hit_rate", (float)speculationHits / (speculationHits + speculationMisses));
+	  store->recordStat("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	  previous = { t, speculation.action, robustness };
+	  return speculation.action;
+	}
+      }
+      speculationMisses++;
+      store->recordStat("speculation_hit", 0);
+      store->recordStat("speculation_hit_rate", (float)speculationHits / (speculationHits + speculationMisses));
+    }
+    if(policy) {
+      // Properties of the table: the active ones, by enforcer, if the enforcers and weights
+      // are those it was synthesized for
+      uint32_t mask = 0;
+      bool matches = enforcers.size() == policy->numProperties();
+      for(unsigned int i = 0; matches && i < properties.size(); i++) {
+	matches = false;
+	for(unsigned int p = 0; p < enforcers.size(); p++) {
+	  if(((StlEnforcer*)enforcers[p].get())->getProp() == properties[i]) {
+	    matches = policy->weight(p) == prop_weights[i];
+	    mask |= 1u << p;
+	    break;
+	  }
+	}
+      }
+      // Use the table's action unless a proposed action beats it here
+      float state[PolicyTable::AXES];
+      PolicyTable::situation(store->getSignal(), state);
+      Offboard::VelocityNEDYaw action;
+      policyLookups++;
+      if(matches && policy->lookup(state, mask, action)) {
+	float robustness;
+	if(validates(action, properties, prop_weights, actions, t, robustness)) {
+	  policyHits++;
+	  cout << "Policy table hit: robustness " << robustness << endl;
+	  store->recordStat("policy_hit", 1);
+	  store->recordStat("policy_hit_rate", (float)policyHits / policyLookups);
+	  store->recordStat("synthesis_ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	  previous = { t, action, robustness };
+	  return action;
+	}
+      }
+      store->recordStat("policy_hit", 0);
+      store->recordStat("policy_hit_rate", (float)policyHits / policyLookups);
+    }
+
+    DecisionCache::Key key;
+    if(cache) {
+      // A repeated situation: reuse its decision if it still holds up here, i.e., it is
+      // within CACHE_TOLERANCE of its robustness then and no worse than the proposed actions
+      key = cache->key(store->getSignal(), properties);
+      cacheLookups++;
+      const DecisionCache::Entry* entry = cache->find(key);
+      if(entry) {
+	float robustness;
+	if(validates(entry->action, properties, prop_weights, actions, t, robustness) &&
+	   robustness >= entry->robustness - droneutil::CACHE_TOLERANCE) {
+	  float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	  cacheHits++;
+	  cacheSavedMs += entry->synthesisMs - ms;
+	  cout << "Decision cache hit: robustness " << robustness << " (was " << entry->robustness << ")" << endl;
+	  store->recordStat("cache_hit", 1);
+	  store->recordStat("cache_hit_rate", (float)cacheHits / cacheLookups);
+	  store->recordStat("cache_saved_ms", cacheSavedMs);
+	  store->recordStat("synthesis_ms", ms);
+	  previous = { t, entry->action, robustness };
+	  return previous.action;
+	}
+	// Otherwise synthesized again (and replaced) below
+      }
+    }
+
+    // Warm start from the previous tick's decision during a sustained conflict
+    bool warm = droneutil::TRUST_REGION && previous.tick >= 0 && previous.tick == t - 1;
+    float robustness;
+    auto action = get_optimal_action(properties, prop_weights, actions, store, t, *model, *generator,
+				     synthesisDeadline(), pool.get(), warm ? &previous : nullptr, robustness);
+    previous = { t, action, robustness };
+    if(cache) {
+      float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+      cache->insert(key, { action, robustness, ms });
+      store->recordStat("cache_hit", 0);
+      store->recordStat("cache_hit_rate", (float)cacheHits / cacheLookups);
+      store->recordStat("cache_saved_ms", cacheSavedMs);
+    }
+    return action;
   }
 
   void RobustnessCoordinator::sendVelocityNed(const dronecode_sdk::Offboard::VelocityNEDYaw &velocity_ned_yaw){
@@ -426,7 +1294,7 @@ namespace cdra {
       int numActiveEnforcers = activeEnforcers.size();
       cout << "### Mutliple enforcers activated: " << numActiveEnforcers << endl;
       
-      newNED = get_optimal_action(properties, prop_weights, actions, store, activeEnforcers.at(0)->getTime());
+      newNED = synthesize(properties, prop_weights, actions, activeEnforcers.at(0)->getTime());
 
       if(!droneutil::SUGGEST_ACTION_RANGE) {
 	assert(activeEnforcers.size() == actions.size());
@@ -452,5 +1320,10 @@ namespace cdra {
 
     newNED.yaw_deg = velocity_ned_yaw.yaw_deg;
     Coordinator::sendVelocityNed(newNED);
+
+    if(speculator) {
+      // Use the rest of the tick to resolve the next tick's likely conflicts
+      speculator->post(store->currTick() + 1, store->getSignal(), newNED, properties, store->deadline());
+    }
   }
 }
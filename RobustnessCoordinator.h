@@ -27,15 +27,67 @@
 
 #include "Coordinator.h"
 #include "StlEnforcer.h"
+#include "CandidateGenerator.h"
+#include "ThreadPool.h"
+#include "DroneModel.h"
+#include "DecisionCache.h"
+#include "PolicyTable.h"
+#include "Speculator.h"
+#include <chrono>
 #include <map>
 
 namespace cdra {
 
     class RobustnessCoordinator : public Coordinator {
+    public:
+        // Action chosen at a tick with multiple active enforcers
+        struct Decision {
+            int tick;                                   // -1 if none yet
+            dronecode_sdk::Offboard::VelocityNEDYaw action;
+            float robustness;                           // weighted, of the action
+        };
 
+    private:
         // Weights of the enforcers
         std::map<StlEnforcer*, float> weights;
 
+    protected:
+        // Points used to synthesize candidate actions
+        std::unique_ptr<CandidateGenerator> generator;
+        // Workers scoring the candidates (null if SYNTHESIS_THREADS is 1)
+        std::unique_ptr<ThreadPool> pool;
+        // Dynamics predicting the outcome of the candidates (see DRONE_MODEL)
+        std::unique_ptr<DroneModel> model;
+        // Latest decision, from which the next search is warm-started
+        Decision previous {-1, {0, 0, 0, 0}, 0};
+        // Decisions of past conflicts (null unless DECISION_CACHE)
+        std::unique_ptr<DecisionCache> cache;
+        unsigned int cacheLookups = 0, cacheHits = 0;
+        float cacheSavedMs = 0; // synthesis time saved by the hits (net of validating them)
+        // Actions synthesized offline (null unless POLICY_TABLE_FILE)
+        std::unique_ptr<PolicyTable> policy;
+        unsigned int policyLookups = 0, policyHits = 0;
+        // Resolves the next tick's likely conflicts in the slack (null unless SPECULATIVE_SYNTHESIS)
+        std::unique_ptr<Speculator> speculator;
+        unsigned int speculationHits = 0, speculationMisses = 0;
+
+        // Time by which synthesis should be done (see SYNTHESIS_DEADLINE)
+        std::chrono::steady_clock::time_point synthesisDeadline();
+        // Whether a reused "action" (speculated, from the policy table or cached) holds up at
+        // tick "t": it is no less robust than any of the proposed "actions"; sets "robustness"
+        // to its weighted robustness
+        bool validates(const dronecode_sdk::Offboard::VelocityNEDYaw& action,
+                       const std::vector<StlExpr*>& properties,
+                       const std::vector<float>& weights,
+                       const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                       int t, float& robustness);
+        // Resolves a conflict at tick "t": returns the action to perform given the
+        // active enforcers' properties, their weights, and their proposed actions
+        virtual dronecode_sdk::Offboard::VelocityNEDYaw synthesize(const std::vector<StlExpr*>& properties,
+                                                                   const std::vector<float>& weights,
+                                                                   const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& actions,
+                                                                   int t);
+
     public:
         RobustnessCoordinator(std::shared_ptr<dronecode_sdk::Offboard> offboard,
 			      std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
@@ -46,4 +98,26 @@ namespace cdra {
     };
 }
 
+/* Returns the most robust action for the active "properties" at tick "t" among the
+ * "conflicting_actions" and (if SYNTHESIZE_ACTIONS) synthesized ones, found by the deadline,
+ * and sets "robustness" to its weighted robustness (see RobustnessCoordinator.cpp).
+ * A "quiet" synthesis (off the control loop) neither logs nor records stats in "store" */
+dronecode_sdk::Offboard::VelocityNEDYaw get_optimal_action(const std::vector<cdra::StlExpr*>& properties,
+							   const std::vector<float>& weights,
+							   const std::vector<dronecode_sdk::Offboard::VelocityNEDYaw>& conflicting_actions,
+							   std::shared_ptr<cdra::StateStore> store,
+							   int t,
+							   const cdra::DroneModel& model,
+							   cdra::CandidateGenerator& generator,
+							   std::chrono::steady_clock::time_point deadline,
+							   cdra::ThreadPool* pool,
+							   const cdra::RobustnessCoordinator::Decision* warm_start,
+							   float& robustness,
+							   bool quiet = false);
+
+/* Candidate actions synthesized from "generator" for the conflicting "base_actions", in
+ * generation order: on their spherical cap if SAMPLE_ON_SPHERE, else in their box */
+std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> get_reasonable_actions(std::vector<dronecode_sdk::Offboard::VelocityNEDYaw> base_actions,
+									     cdra::CandidateGenerator& generator);
+
 #endif //MISSIONAPP_ROBUSTNESS_COORDINATOR_H
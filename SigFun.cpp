@@ -28,6 +28,7 @@
 #include "SigFun.h"
 #include "Signal.h"
 #include "DroneUtil.h"
+#include "SigKernels.h"
 
 namespace cdra {
   
@@ -52,6 +53,9 @@ float scaleToCurve(float x) {
 }
   
 float SigFun::normalizeValue(float value) {
+  if(droneutil::FAST_NORMALIZATION) {
+    return kernels::normalize(value, minValue, maxValue, droneutil::NONLINEAR_PENALTY);
+  }
   if(value == 0) {
     return 0;
   } else if(value < 0) {
@@ -76,6 +80,49 @@ float SigFun::normalizeValue(float value) {
   }
 }
   
+void SigFun::normalizeBatch(float* values, int n) {
+  if(droneutil::FAST_NORMALIZATION) {
+    kernels::normalize(values, n, minValue, maxValue, droneutil::NONLINEAR_PENALTY);
+    return;
+  }
+  for(int i = 0; i < n; i++) {
+    values[i] = normalizeValue(values[i]);
+  }
+}
+
+void SigFun::valueBatch(const StateBatch& states, float* out) {
+  // Evaluate every state as the latest tick of a one-state signal
+  Signal sig(StateBatch::channelNames());
+  for(int i = 0; i < states.size(); i++) {
+    sig.append(states.row(i));
+    out[i] = value(&sig, 1);
+    sig.pop();
+  }
+}
+  
+bool SigFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+  // Default function has no known region
+  return false;
+}
+  
+bool SigFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+  // Default function has no known bounds
+  return false;
+}
+
+void SigFun::normalizedRange(float& lower, float& upper) {
+  // normalizeValue is non-decreasing and truncates to [minValue, maxValue]
+  lower = normalizeValue(minValue);
+  upper = normalizeValue(maxValue);
+}
+
+bool SigFun::valueRange(float& lower, float& upper) {
+  // Functions that normalize set their range at construction
+  if (!(minValue < maxValue)) return false;
+  normalizedRange(lower, upper);
+  return true;
+}
+  
 bool SigFun::prop(Signal *sig, int t) {
   // Default function just returns true
   return true;
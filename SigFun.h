@@ -26,6 +26,8 @@
 #define SIGFUN_H_
 
 #include "Signal.h"
+#include "StateBatch.h"
+#include "ActionRegion.h"
 #include <limits>
 
 namespace cdra {
@@ -43,6 +45,9 @@ namespace cdra {
     float minValue = std::numeric_limits<float>::max();
     float maxValue = std::numeric_limits<float>::min();
     float normalizedZero = 0 - minValue / maxValue - minValue;
+
+    // Bounds every (normalized) value of this function, whatever the state
+    void normalizedRange(float& lower, float& upper);
     
   public:
     // Returns the result of applying this function to sig at tick t
@@ -58,6 +63,28 @@ namespace cdra {
     virtual std::string propStr() { return "T"; };
     virtual std::string enforcer_name() { return "Prop"; };
     float normalizeValue(float value);
+    // Normalizes "n" values in place (see normalizeValue)
+    void normalizeBatch(float* values, int n);
+    // Writes the value of this function for each state of the batch to "out"
+    // (i.e., value(sig, t) where the batch holds candidate signal values at t).
+    // The default implementation evaluates each state on its own; signal
+    // functions override it with batch kernels (see SigKernels.h).
+    virtual void valueBatch(const StateBatch& states, float* out);
+    // Restricts "region" to the commanded velocities that satisfy prop()
+    // after being held for "horizon" seconds from the state at tick t
+    // (assuming the velocity is reached immediately and the enemy keeps its
+    // velocity). The region may be a conservative (inner) approximation.
+    // Returns false if this function does not describe its region.
+    virtual bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+    // Bounds every value of this function, whatever the state (see
+    // normalizedRange); returns false if this function does not normalize
+    // its values.
+    bool valueRange(float& lower, float& upper);
+    // Bounds the value of this function over every state within "bounds":
+    // sets "lower" and "upper" so that lower <= value <= upper (up to
+    // rounding) for each of them. Returns false if this function does not
+    // bound its value.
+    virtual bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
   };
   
 }
@@ -0,0 +1,374 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "SigKernels.h"
+#include "DroneUtil.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_HAVE_AVX2 1
+#include <immintrin.h>
+#define KERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define KERNELS_HAVE_AVX2 0
+#endif
+
+namespace cdra {
+namespace kernels {
+
+  // TTI reported when the drone does not move towards either side of an axis
+  static const float NO_TTI = 1000.0f;
+
+  bool avx2Available() {
+#if KERNELS_HAVE_AVX2
+    static const bool available = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return available;
+#else
+    return false;
+#endif
+  }
+
+  static bool useAvx2() {
+    return droneutil::SIMD_KERNELS && avx2Available();
+  }
+
+  /*
+   * Scalar kernels
+   * Written as selects over all the cases rather than nested branches;
+   * they compute exactly the same values as the AVX2 versions below.
+   */
+  
+  // TTI along one axis; same case analysis as TTIFun::computeTTI
+  static inline float ttiAxis(float p, float v, float lo, float hi) {
+    float safe_v = v == 0.0f ? 1.0f : v;
+    float dlo = p - lo, dhi = hi - p;
+    float below  = v > 0.0f ? dlo / safe_v : dlo + v;
+    float above  = v < 0.0f ? dhi / safe_v : dhi - v;
+    float inside = v < 0.0f ? dlo / -safe_v : (v > 0.0f ? dhi / safe_v : NO_TTI);
+    return p <= lo ? below : (p >= hi ? above : inside);
+  }
+
+  static inline float minf(float res, float x) {
+    return x < res ? x : res;
+  }
+
+  static void ttiScalar(const float* pn, const float* pe, const float* pd,
+			const float* vn, const float* ve, const float* vd,
+			int begin, int n, float lowerx, float upperx, float lowery, float uppery,
+			float lowerz, float upperz, float* out) {
+    for (int i = begin; i < n; i++) {
+      float res = NO_TTI;
+      res = minf(res, ttiAxis(pn[i], vn[i], lowerx, upperx));
+      res = minf(res, ttiAxis(pe[i], ve[i], lowery, uppery));
+      res = minf(res, ttiAxis(-pd[i], -vd[i], lowerz, upperz));
+      out[i] = res;
+    }
+  }
+
+  static void dttScalar(const float* x1, const float* y1, const float* z1,
+			const float* x2, const float* y2, const float* z2,
+			int begin, int n, float* out) {
+    for (int i = begin; i < n; i++) {
+      float dx = x2[i] - x1[i], dy = y2[i] - y1[i], dz = z2[i] - z1[i];
+      out[i] = sqrtf(dx*dx + dy*dy + dz*dz);
+    }
+  }
+
+  static void dteScalar(const float* pn, const float* pe, const float* pd,
+			int begin, int n, float goal_z, float acceptable_range,
+			float lowerx, float lowery, float upperx, float uppery,
+			float* out, float* in_zone) {
+    for (int i = begin; i < n; i++) {
+      bool in_x = pn[i] >= lowerx && pn[i] <= upperx;
+      bool in_y = pe[i] >= lowery && pe[i] <= uppery;
+      in_zone[i] = (in_x && in_y) ? 1.0f : 0.0f;
+      out[i] = acceptable_range - fabsf(-pd[i] - goal_z);
+    }
+  }
+
+  // Minimax polynomial for 2^f on [0, 1) (relative error 7.5e-8)
+  static const float EXP2_C0 = 9.999999251e-01f;
+  static const float EXP2_C1 = 6.931530732e-01f;
+  static const float EXP2_C2 = 2.401536170e-01f;
+  static const float EXP2_C3 = 5.582631805e-02f;
+  static const float EXP2_C4 = 8.989340095e-03f;
+  static const float EXP2_C5 = 1.877576673e-03f;
+  // Penalty curve base 32 = 2^CURVE_EXP
+  static const float CURVE_EXP = 5.0f;
+
+  // 2^u for u in [0, CURVE_EXP]
+  static inline float exp2Scalar(float u) {
+    int i = (int)u; // truncation is floor for u >= 0
+    float f = u - (float)i;
+    float p = EXP2_C5;
+    p = p * f + EXP2_C4;
+    p = p * f + EXP2_C3;
+    p = p * f + EXP2_C2;
+    p = p * f + EXP2_C1;
+    p = p * f + EXP2_C0;
+    // Multiply by 2^i through the exponent bits
+    int32_t bits;
+    std::memcpy(&bits, &p, sizeof(bits));
+    bits += i << 23;
+    std::memcpy(&p, &bits, sizeof(bits));
+    return p;
+  }
+
+  static inline float curveScalar(float x) {
+    float u = -CURVE_EXP * x;
+    u = u < 0.0f ? 0.0f : u;
+    u = u > CURVE_EXP ? CURVE_EXP : u;
+    return -((exp2Scalar(u) - 1.0f) / 31.0f) + x;
+  }
+
+  static inline float normalizeScalar(float value, float minValue, float maxValue, bool nonlinear) {
+    float neg = value < minValue ? minValue : value;
+    neg = (neg - minValue) / (0 - minValue) - 1;
+    neg = nonlinear ? curveScalar(neg) : 2 * neg;
+    float pos = (value > maxValue ? maxValue : value) / maxValue;
+    return value < 0 ? neg : pos;
+  }
+
+#if KERNELS_HAVE_AVX2
+  /*
+   * AVX2 kernels (8 states per iteration)
+   */
+  
+  KERNELS_AVX2 static inline __m256 neg8(__m256 x) {
+    return _mm256_xor_ps(x, _mm256_set1_ps(-0.0f));
+  }
+
+  KERNELS_AVX2 static inline __m256 min8(__m256 res, __m256 x) {
+    return _mm256_blendv_ps(res, x, _mm256_cmp_ps(x, res, _CMP_LT_OQ));
+  }
+  
+  KERNELS_AVX2 static inline __m256 ttiAxis8(__m256 p, __m256 v, __m256 lo, __m256 hi) {
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 vpos = _mm256_cmp_ps(v, zero, _CMP_GT_OQ);
+    __m256 vneg = _mm256_cmp_ps(v, zero, _CMP_LT_OQ);
+    __m256 safe_v = _mm256_blendv_ps(v, _mm256_set1_ps(1.0f), _mm256_cmp_ps(v, zero, _CMP_EQ_OQ));
+    __m256 dlo = _mm256_sub_ps(p, lo), dhi = _mm256_sub_ps(hi, p);
+    __m256 below  = _mm256_blendv_ps(_mm256_add_ps(dlo, v), _mm256_div_ps(dlo, safe_v), vpos);
+    __m256 above  = _mm256_blendv_ps(_mm256_sub_ps(dhi, v), _mm256_div_ps(dhi, safe_v), vneg);
+    __m256 inside = _mm256_blendv_ps(_mm256_set1_ps(NO_TTI), _mm256_div_ps(dhi, safe_v), vpos);
+    inside = _mm256_blendv_ps(inside, _mm256_div_ps(dlo, neg8(safe_v)), vneg);
+    __m256 res = _mm256_blendv_ps(inside, above, _mm256_cmp_ps(p, hi, _CMP_GE_OQ));
+    return _mm256_blendv_ps(res, below, _mm256_cmp_ps(p, lo, _CMP_LE_OQ));
+  }
+
+  KERNELS_AVX2 static int ttiAvx2(const float* pn, const float* pe, const float* pd,
+				  const float* vn, const float* ve, const float* vd,
+				  int n, float lowerx, float upperx, float lowery, float uppery,
+				  float lowerz, float upperz, float* out) {
+    const __m256 lx = _mm256_set1_ps(lowerx), ux = _mm256_set1_ps(upperx);
+    const __m256 ly = _mm256_set1_ps(lowery), uy = _mm256_set1_ps(uppery);
+    const __m256 lz = _mm256_set1_ps(lowerz), uz = _mm256_set1_ps(upperz);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m256 res = _mm256_set1_ps(NO_TTI);
+      res = min8(res, ttiAxis8(_mm256_loadu_ps(pn + i), _mm256_loadu_ps(vn + i), lx, ux));
+      res = min8(res, ttiAxis8(_mm256_loadu_ps(pe + i), _mm256_loadu_ps(ve + i), ly, uy));
+      res = min8(res, ttiAxis8(neg8(_mm256_loadu_ps(pd + i)), neg8(_mm256_loadu_ps(vd + i)), lz, uz));
+      _mm256_storeu_ps(out + i, res);
+    }
+    return i;
+  }
+
+  KERNELS_AVX2 static int dttAvx2(const float* x1, const float* y1, const float* z1,
+				  const float* x2, const float* y2, const float* z2,
+				  int n, float* out) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x2 + i), _mm256_loadu_ps(x1 + i));
+      __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y2 + i), _mm256_loadu_ps(y1 + i));
+      __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z2 + i), _mm256_loadu_ps(z1 + i));
+      __m256 sq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+				_mm256_mul_ps(dz, dz));
+      _mm256_storeu_ps(out + i, _mm256_sqrt_ps(sq));
+    }
+    return i;
+  }
+
+  KERNELS_AVX2 static int dteAvx2(const float* pn, const float* pe, const float* pd,
+				  int n, float goal_z, float acceptable_range,
+				  float lowerx, float lowery, float upperx, float uppery,
+				  float* out, float* in_zone) {
+    const __m256 lx = _mm256_set1_ps(lowerx), ux = _mm256_set1_ps(upperx);
+    const __m256 ly = _mm256_set1_ps(lowery), uy = _mm256_set1_ps(uppery);
+    const __m256 goal = _mm256_set1_ps(goal_z), range = _mm256_set1_ps(acceptable_range);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m256 north = _mm256_loadu_ps(pn + i), east = _mm256_loadu_ps(pe + i);
+      __m256 in = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(north, lx, _CMP_GE_OQ),
+					      _mm256_cmp_ps(north, ux, _CMP_LE_OQ)),
+				_mm256_and_ps(_mm256_cmp_ps(east, ly, _CMP_GE_OQ),
+					      _mm256_cmp_ps(east, uy, _CMP_LE_OQ)));
+      __m256 delta = _mm256_sub_ps(neg8(_mm256_loadu_ps(pd + i)), goal);
+      delta = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), delta);
+      _mm256_storeu_ps(in_zone + i, _mm256_and_ps(in, one));
+      _mm256_storeu_ps(out + i, _mm256_sub_ps(range, delta));
+    }
+    return i;
+  }
+
+  KERNELS_AVX2 static inline __m256 exp2Avx2(__m256 u) {
+    __m256i i = _mm256_cvttps_epi32(u);
+    __m256 f = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+    __m256 p = _mm256_set1_ps(EXP2_C5);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C0));
+    return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(p), _mm256_slli_epi32(i, 23)));
+  }
+
+  KERNELS_AVX2 static inline __m256 curveAvx2(__m256 x) {
+    const __m256 zero = _mm256_setzero_ps(), max_u = _mm256_set1_ps(CURVE_EXP);
+    __m256 u = _mm256_mul_ps(_mm256_set1_ps(-CURVE_EXP), x);
+    u = _mm256_blendv_ps(u, zero, _mm256_cmp_ps(u, zero, _CMP_LT_OQ));
+    u = _mm256_blendv_ps(u, max_u, _mm256_cmp_ps(u, max_u, _CMP_GT_OQ));
+    __m256 e = _mm256_div_ps(_mm256_sub_ps(exp2Avx2(u), _mm256_set1_ps(1.0f)), _mm256_set1_ps(31.0f));
+    return _mm256_add_ps(neg8(e), x);
+  }
+
+  KERNELS_AVX2 static int curveAvx2(float* values, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      _mm256_storeu_ps(values + i, curveAvx2(_mm256_loadu_ps(values + i)));
+    }
+    return i;
+  }
+
+  KERNELS_AVX2 static int normalizeAvx2(float* values, int n, float minValue, float maxValue,
+					bool nonlinear) {
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    const __m256 lo = _mm256_set1_ps(minValue), hi = _mm256_set1_ps(maxValue);
+    const __m256 range = _mm256_set1_ps(0 - minValue);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m256 value = _mm256_loadu_ps(values + i);
+      __m256 neg = _mm256_blendv_ps(value, lo, _mm256_cmp_ps(value, lo, _CMP_LT_OQ));
+      neg = _mm256_sub_ps(_mm256_div_ps(_mm256_sub_ps(neg, lo), range), one);
+      neg = nonlinear ? curveAvx2(neg) : _mm256_mul_ps(_mm256_set1_ps(2.0f), neg);
+      __m256 pos = _mm256_blendv_ps(value, hi, _mm256_cmp_ps(value, hi, _CMP_GT_OQ));
+      pos = _mm256_div_ps(pos, hi);
+      _mm256_storeu_ps(values + i, _mm256_blendv_ps(pos, neg, _mm256_cmp_ps(value, zero, _CMP_LT_OQ)));
+    }
+    return i;
+  }
+#endif
+
+  /*
+   * Dispatch
+   */
+  
+  void tti(const float* pos_north, const float* pos_east, const float* pos_down,
+	   const float* vel_north, const float* vel_east, const float* vel_down,
+	   int n, float lowerx, float upperx, float lowery, float uppery,
+	   float lowerz, float upperz, float* out) {
+    int done = 0;
+#if KERNELS_HAVE_AVX2
+    if (useAvx2()) {
+      done = ttiAvx2(pos_north, pos_east, pos_down, vel_north, vel_east, vel_down,
+		     n, lowerx, upperx, lowery, uppery, lowerz, upperz, out);
+    }
+#endif
+    ttiScalar(pos_north, pos_east, pos_down, vel_north, vel_east, vel_down,
+	      done, n, lowerx, upperx, lowery, uppery, lowerz, upperz, out);
+  }
+
+  void dtt(const float* x1, const float* y1, const float* z1,
+	   const float* x2, const float* y2, const float* z2,
+	   int n, float* out) {
+    int done = 0;
+#if KERNELS_HAVE_AVX2
+    if (useAvx2()) {
+      done = dttAvx2(x1, y1, z1, x2, y2, z2, n, out);
+    }
+#endif
+    dttScalar(x1, y1, z1, x2, y2, z2, done, n, out);
+  }
+
+  void dtg(const float* pos_down, int n, float ground_z, float* out) {
+    // Simple enough for the compiler to vectorize on its own
+    for (int i = 0; i < n; i++) {
+      out[i] = -pos_down[i] - ground_z;
+    }
+  }
+
+  void dte(const float* pos_north, const float* pos_east, const float* pos_down,
+	   int n, float goal_z, float acceptable_range,
+	   float lowerx, float lowery, float upperx, float uppery,
+	   float* out, float* in_zone) {
+    int done = 0;
+#if KERNELS_HAVE_AVX2
+    if (useAvx2()) {
+      done = dteAvx2(pos_north, pos_east, pos_down, n, goal_z, acceptable_range,
+		     lowerx, lowery, upperx, uppery, out, in_zone);
+    }
+#endif
+    dteScalar(pos_north, pos_east, pos_down, done, n, goal_z, acceptable_range,
+	      lowerx, lowery, upperx, uppery, out, in_zone);
+  }
+
+  float penaltyCurve(float x) {
+    return curveScalar(x);
+  }
+
+  void penaltyCurve(float* values, int n) {
+    int done = 0;
+#if KERNELS_HAVE_AVX2
+    if (useAvx2()) {
+      done = curveAvx2(values, n);
+    }
+#endif
+    for (int i = done; i < n; i++) {
+      values[i] = curveScalar(values[i]);
+    }
+  }
+
+  float normalize(float value, float minValue, float maxValue, bool nonlinear) {
+    return normalizeScalar(value, minValue, maxValue, nonlinear);
+  }
+
+  void normalize(float* values, int n, float minValue, float maxValue, bool nonlinear) {
+    int done = 0;
+#if KERNELS_HAVE_AVX2
+    if (useAvx2()) {
+      done = normalizeAvx2(values, n, minValue, maxValue, nonlinear);
+    }
+#endif
+    for (int i = done; i < n; i++) {
+      values[i] = normalizeScalar(values[i], minValue, maxValue, nonlinear);
+    }
+  }
+
+}
+}
@@ -0,0 +1,90 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_SIGKERNELS_H
+#define MISSIONAPP_SIGKERNELS_H
+
+namespace cdra {
+
+  /**
+   * Branchless batch kernels for the signal functions.
+   * Every kernel works on structure-of-arrays buffers of "n" states and
+   * writes one (un-normalized) value per state to "out".
+   * An AVX2 implementation is used when the CPU supports it (checked once
+   * at runtime) and droneutil::SIMD_KERNELS is set; otherwise a portable
+   * scalar implementation computing the same values is used.
+   */
+  namespace kernels {
+
+    // true iff the AVX2 kernels are available on this CPU
+    bool avx2Available();
+
+    // Time-to-intercept of an axis-aligned box (see TTIFun::computeTTI)
+    // Note: positions/velocities are in NED; the box z bounds are "up"
+    void tti(const float* pos_north, const float* pos_east, const float* pos_down,
+	     const float* vel_north, const float* vel_east, const float* vel_down,
+	     int n, float lowerx, float upperx, float lowery, float uppery,
+	     float lowerz, float upperz, float* out);
+
+    // Euclidean distance between two sets of positions (see DTTFun::computeDTT)
+    void dtt(const float* x1, const float* y1, const float* z1,
+	     const float* x2, const float* y2, const float* z2,
+	     int n, float* out);
+
+    // Height above a flat ground at altitude ground_z (see DTGFun::computeDTG)
+    void dtg(const float* pos_down, int n, float ground_z, float* out);
+
+    // Distance to elevation of a recon zone (see ReconFun::computeDTE)
+    // "in_zone" is set to 1 for states inside the zone's xy-region, 0 otherwise
+    void dte(const float* pos_north, const float* pos_east, const float* pos_down,
+	     int n, float goal_z, float acceptable_range,
+	     float lowerx, float lowery, float upperx, float uppery,
+	     float* out, float* in_zone);
+
+    /*
+     * Approximate robustness normalization (see SigFun::normalizeValue)
+     * The penalty curve -((32^-x - 1) / 31) + x on [-1, 0] is computed
+     * as 2^(-5x) by range reduction (integer part into the exponent bits)
+     * and a degree 5 minimax polynomial for 2^f on [0, 1), relative error
+     * 7.5e-8. Over every float in [-1, 0] the absolute error of the curve
+     * against the curve computed in double precision is at most
+     * PENALTY_CURVE_MAX_ERROR (3.9e-7 measured by an exhaustive sweep,
+     * i.e., about 2 ulp of the [-2, 0] result; "make check" runs the
+     * sweep). The linear parts are computed exactly as in normalizeValue.
+     */
+    const float PENALTY_CURVE_MAX_ERROR = 4e-7f;
+
+    // Approximate penalty curve for x in [-1, 0] (inputs are clamped)
+    float penaltyCurve(float x);
+    // Same for "n" values in place
+    void penaltyCurve(float* values, int n);
+    // Approximate normalizeValue for a function with the given value range
+    float normalize(float value, float minValue, float maxValue, bool nonlinear);
+    // Normalizes "n" values in place (approximate normalizeValue)
+    void normalize(float* values, int n, float minValue, float maxValue, bool nonlinear);
+  }
+
+}
+
+#endif //MISSIONAPP_SIGKERNELS_H
@@ -53,16 +53,23 @@ namespace cdra {
     signal.push_back(next);
   }
  
+  int Signal::column(const std::string& name) const {
+    auto it = index.find(name);
+    if (it == index.end())
+      throw "Signal unavailable!";
+    return it->second;
+  }
+
   // Return the current value of the named signal
   float Signal::value(std::string name){
-    return signal.back()[index[name]];
+    return signal.back()[column(name)];
   }
   
   // Return the value of the named signal at time tick "t"
   float Signal::value(std::string name, int t){
     if (signal.size() - 1 < t)
       throw "Signal unavailable!";
-    return signal[t][index[name]];
+    return signal[t][column(name)];
   }
 
   bool Signal::available(int t){
@@ -44,6 +44,8 @@ namespace cdra {
     std::map<std::string, int> index;
     // Signal is a sequence of vectors of index values
     std::vector<std::vector<float>> signal;
+    // Index of the named signal (read-only, so lookups are thread-safe)
+    int column(const std::string& name) const;
     
   public:
     Signal(std::vector<std::string> signalNames);
@@ -0,0 +1,190 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include <iostream>
+#include <math.h>
+
+#include "Speculator.h"
+#include "ActionScorer.h"
+#include "DroneUtil.h"
+#include "RobustnessCoordinator.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+
+namespace cdra {
+
+  Speculator::Speculator(const DroneModel& model)
+    : model(model),
+      generator(CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED)),
+      store(std::make_shared<StateStore>(nullptr, nullptr)) {
+    // (once every member is initialized)
+    worker = std::thread(&Speculator::run, this);
+  }
+
+  Speculator::~Speculator() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+    }
+    posted.notify_one();
+    worker.join();
+  }
+
+  void Speculator::addProperty(StlExpr* property, float weight) {
+    std::lock_guard<std::mutex> guard(lock);
+    properties.push_back(property);
+    weights.push_back(weight);
+  }
+
+  void Speculator::post(int tick, Signal* signal, const Offboard::VelocityNEDYaw& action,
+			const vector<StlExpr*>& active, std::chrono::steady_clock::time_point deadline) {
+    const auto& names = StateBatch::channelNames();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      job.tick = tick;
+      // Rows are only appended to the committed signal (by this thread), so those
+      // handed over already stay as they were
+      for(; handed < signal->length(); handed++) {
+	vector<float> row(StateBatch::NUM_CHANNELS);
+	for(int c = 0; c < StateBatch::NUM_CHANNELS; c++) {
+	  row[c] = signal->value(names[c], handed);
+	}
+	job.rows.push_back(row);
+      }
+      for(int c = 0; c < StateBatch::NUM_CHANNELS; c++) {
+	job.state[c] = signal->value(names[c]);
+      }
+      job.action = action;
+      job.active = active;
+      job.deadline = deadline;
+      pending = true;
+    }
+    posted.notify_one();
+  }
+
+  bool Speculator::find(int tick, const vector<StlExpr*>& active, const float situation[PolicyTable::AXES],
+			Speculation& speculation) {
+    std::lock_guard<std::mutex> guard(lock);
+    for(auto& candidate : speculations) {
+      if(candidate.tick != tick || candidate.properties != active) {
+	continue;
+      }
+      // Positions and enemy offset within the position tolerance, velocity within the velocity one
+      bool close = true;
+      for(int a = 0; a < PolicyTable::AXES; a++) {
+	float tolerance = (a >= 3 && a < 6) ? droneutil::SPECULATION_VELOCITY_TOLERANCE
+	                                    : droneutil::SPECULATION_POSITION_TOLERANCE;
+	close = close && fabsf(situation[a] - candidate.situation[a]) <= tolerance;
+      }
+      if(close) {
+	speculation = candidate;
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void Speculator::run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while(true) {
+      posted.wait(guard, [this] { return pending || stopping; });
+      if(stopping) {
+	return;
+      }
+      Job current = job;
+      job.rows.clear();
+      pending = false;
+      speculations.clear();
+      guard.unlock();
+      speculate(current);
+      guard.lock();
+    }
+  }
+
+  void Speculator::speculate(const Job& job) {
+    // Every direction is searched: the next tick's proposed actions are not known yet
+    float speed = droneutil::MAX_DRONE_SPEED;
+    vector<Offboard::VelocityNEDYaw> seeds {
+      { speed, 0, 0, 0 }, { -speed, 0, 0, 0 }, { 0, speed, 0, 0 }, { 0, -speed, 0, 0 } };
+    if(droneutil::EGO_Z_VELOCITY) {
+      seeds.push_back({ 0, 0, speed, 0 });
+      seeds.push_back({ 0, 0, -speed, 0 });
+    }
+
+    Signal* signal = store->getSignal();
+    for(auto& row : job.rows) {
+      signal->append(row);
+    }
+    if(signal->length() != job.tick) {
+      return; // not the tick after the committed signal
+    }
+
+    float next[StateBatch::NUM_CHANNELS];
+    predictNextTick(model, job.state, job.action, next);
+    signal->append(vector<float>(next, next + StateBatch::NUM_CHANNELS));
+    int t = job.tick;
+
+    // Likely active properties: those violated at the predicted state, then those active now
+    vector<StlExpr*> predicted;
+    vector<float> predicted_weights, active_weights;
+    for(unsigned int p = 0; p < properties.size(); p++) {
+      if(!properties[p]->sat(signal, t)) {
+	predicted.push_back(properties[p]);
+	predicted_weights.push_back(weights[p]);
+      }
+      for(auto property : job.active) {
+	if(property == properties[p]) {
+	  active_weights.push_back(weights[p]);
+	}
+      }
+    }
+    vector<pair<vector<StlExpr*>, vector<float>>> sets;
+    if(predicted.size() >= 2) {
+      sets.push_back({ predicted, predicted_weights });
+    }
+    if(job.active.size() >= 2 && job.active != predicted) {
+      sets.push_back({ job.active, active_weights });
+    }
+
+    for(auto& set : sets) {
+      if(std::chrono::steady_clock::now() >= job.deadline) {
+	break;
+      }
+      Speculation speculation;
+      speculation.tick = job.tick;
+      speculation.properties = set.first;
+      PolicyTable::situation(signal, speculation.situation);
+      speculation.action = get_optimal_action(set.first, set.second, seeds, store, t, model, *generator,
+					      job.deadline, nullptr, nullptr, speculation.robustness, true);
+      std::lock_guard<std::mutex> guard(lock);
+      if(pending || stopping) {
+	break; // superseded
+      }
+      speculations.push_back(speculation);
+    }
+    signal->pop();
+  }
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_SPECULATOR_H
+#define MISSIONAPP_SPECULATOR_H
+
+#include <dronecode_sdk/offboard.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CandidateGenerator.h"
+#include "DroneModel.h"
+#include "PolicyTable.h"
+#include "StateBatch.h"
+#include "StateStore.h"
+#include "StlExpr.h"
+
+namespace cdra {
+
+  /**
+   * Resolves the next tick's likely conflicts while the mission sleeps out
+   * the current tick.
+   *
+   * Once a tick's action is sent, the coordinator posts the tick's state
+   * and action; a background worker predicts the next tick's state (one
+   * tick of both drones, see predictNextTick) and synthesizes the action
+   * for the properties violated there and, if different, for those
+   * active now, searching every direction until the deadline. At the next
+   * tick, a conflict over the same properties in a situation within
+   * SPECULATION_POSITION_TOLERANCE / SPECULATION_VELOCITY_TOLERANCE of the
+   * predicted one can take the speculated action.
+   *
+   * The worker has its own candidate generator and a copy of the committed
+   * signal (each post hands over the rows committed since the last one), so
+   * the properties' history is the real one and the predicted state is at
+   * the real next tick. It scores on its own thread only (not the
+   * coordinator's pool).
+   */
+  class Speculator {
+  public:
+    struct Speculation {
+      int tick;                                      // tick it is for
+      std::vector<StlExpr*> properties;              // active properties it assumed
+      float situation[PolicyTable::AXES];            // predicted (see PolicyTable::situation)
+      dronecode_sdk::Offboard::VelocityNEDYaw action;
+      float robustness;                              // weighted, at the predicted state
+    };
+
+  private:
+    // State and action of a tick, to speculate from
+    struct Job {
+      int tick;                                      // tick to speculate for
+      std::vector<std::vector<float>> rows;          // committed since the last job taken
+      float state[StateBatch::NUM_CHANNELS];         // latest state, a signal row
+      dronecode_sdk::Offboard::VelocityNEDYaw action;
+      std::vector<StlExpr*> active;
+      std::chrono::steady_clock::time_point deadline;
+    };
+
+    const DroneModel& model;
+    std::unique_ptr<CandidateGenerator> generator;
+    std::shared_ptr<StateStore> store;               // the worker's copy of the committed signal
+    std::vector<StlExpr*> properties;                // that may become active, in enforcer order
+    std::vector<float> weights;
+
+    std::thread worker;
+    std::mutex lock;                                 // guards the members below
+    std::condition_variable posted;
+    Job job;
+    int handed = 1;                                  // committed rows handed over (the first is the initial one)
+    bool pending = false, stopping = false;
+    std::vector<Speculation> speculations;           // of the latest job
+
+    void run();
+    void speculate(const Job& job);
+
+  public:
+    Speculator(const DroneModel& model);
+    ~Speculator();
+    Speculator(const Speculator&) = delete;
+    Speculator& operator=(const Speculator&) = delete;
+
+    // Adds a property that may become active, with its weight
+    void addProperty(StlExpr* property, float weight);
+    // Speculates for tick "tick" (the one after the latest of "signal", the committed
+    // signal) after "action" is sent with the "active" properties, until "deadline";
+    // replaces any earlier request
+    void post(int tick, Signal* signal, const dronecode_sdk::Offboard::VelocityNEDYaw& action,
+              const std::vector<StlExpr*>& active, std::chrono::steady_clock::time_point deadline);
+    // The speculation for tick "tick" and the "active" properties whose predicted situation
+    // is within tolerance of "situation"; false if there is none (yet)
+    bool find(int tick, const std::vector<StlExpr*>& active, const float situation[PolicyTable::AXES],
+              Speculation& speculation);
+  };
+
+}
+
+#endif //MISSIONAPP_SPECULATOR_H
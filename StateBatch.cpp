@@ -0,0 +1,59 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "StateBatch.h"
+
+namespace cdra {
+
+  void StateBatch::resize(int size) {
+    n = size;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+      channels[c].resize(size);
+    }
+  }
+
+  void StateBatch::setRow(int i, const float* row) {
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+      channels[c][i] = row[c];
+    }
+  }
+
+  std::vector<float> StateBatch::row(int i) const {
+    std::vector<float> r(NUM_CHANNELS);
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+      r[c] = channels[c][i];
+    }
+    return r;
+  }
+
+  const std::vector<std::string>& StateBatch::channelNames() {
+    static const std::vector<std::string> names {
+      "pos_east_m", "pos_north_m", "pos_down_m",
+      "vel_east_m_s", "vel_north_m_s", "vel_down_m_s",
+      "enemy_pos_east_m", "enemy_pos_north_m", "enemy_pos_down_m",
+      "enemy_vel_east_m_s", "enemy_vel_north_m_s", "enemy_vel_down_m_s"};
+    return names;
+  }
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_STATEBATCH_H
+#define MISSIONAPP_STATEBATCH_H
+
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A batch of (estimated) drone states in structure-of-arrays form.
+   * Each channel holds one signal value (in the same order as the
+   * StateStore signal) for every state of the batch, so that signal
+   * functions can evaluate many candidate states at once.
+   */
+  class StateBatch {
+  public:
+    enum Channel {
+      POS_EAST, POS_NORTH, POS_DOWN,
+      VEL_EAST, VEL_NORTH, VEL_DOWN,
+      ENEMY_POS_EAST, ENEMY_POS_NORTH, ENEMY_POS_DOWN,
+      ENEMY_VEL_EAST, ENEMY_VEL_NORTH, ENEMY_VEL_DOWN,
+      NUM_CHANNELS
+    };
+
+  private:
+    int n = 0;
+    std::vector<float> channels[NUM_CHANNELS];
+
+  public:
+    // Number of states in the batch
+    int size() const { return n; };
+    void resize(int size);
+    // Set state "i" from a row of NUM_CHANNELS values in signal order
+    void setRow(int i, const float* row);
+    // Returns state "i" as a row of values in signal order
+    std::vector<float> row(int i) const;
+    const float* data(Channel c) const { return channels[c].data(); };
+    float* data(Channel c) { return channels[c].data(); };
+    // Signal names of the channels, in channel order
+    static const std::vector<std::string>& channelNames();
+  };
+
+  /**
+   * Bounds on a set of (estimated) drone states: every state of the set has
+   * each channel within [lower, upper] (either may be infinite)
+   */
+  struct StateBounds {
+    float lower[StateBatch::NUM_CHANNELS];
+    float upper[StateBatch::NUM_CHANNELS];
+  };
+
+}
+
+#endif //MISSIONAPP_STATEBATCH_H
@@ -23,6 +23,7 @@
  */
 
 #include "StateStore.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <math.h>
@@ -50,6 +51,7 @@ namespace cdra {
 
     void StateStore::recordNewState(){
         // Store the latest signal values
+        tickStart = std::chrono::steady_clock::now();
         tick++;
         // obtain the state of the drone under control
         dronecode_sdk::Telemetry::PositionVelocityNED posvel = telemetry->position_velocity_ned();
@@ -94,6 +96,22 @@ namespace cdra {
         return tick;
     }
 
+    void StateStore::recordActOverhead(std::chrono::steady_clock::duration overhead) {
+        actOverhead = std::max(overhead, actOverhead * 9 / 10);
+    }
+
+    std::chrono::steady_clock::time_point StateStore::deadline() {
+        if (tick == 0) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+        std::chrono::duration<float> budget(droneutil::TICK_DURATION - droneutil::DEADLINE_MARGIN);
+        return tickStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget) - actOverhead;
+    }
+
+    void StateStore::recordStat(const std::string& name, float value) {
+        tickStats[name][tick] = value;
+    }
+
     void StateStore::addStlExpr(StlExpr* stlExpr) {
       stlExprs.push_back(stlExpr);
     }
@@ -200,6 +218,17 @@ namespace cdra {
       run_data["coordinators_active"][0].append(active_enforcers);
     }
     
+    // Per-tick statistics (0 for ticks that did not record them)
+    for(auto& stat : tickStats) {
+      Json::Value vec(Json::arrayValue);
+      vec.append(Json::Value(Json::arrayValue));
+      for(int t = 1; t < signal->length(); t++) {
+	auto it = stat.second.find(t);
+	vec[0].append(it == stat.second.end() ? 0.0f : it->second);
+      }
+      run_data[stat.first.c_str()] = vec;
+    }
+
     int num_coordinated_ticks = 0;
     for(auto num_coordinators : run_data["coordinators_active"]) {
       if(num_coordinators >= 2) {
@@ -26,6 +26,8 @@
 #define MISSIONAPP_DRONESTATE_H
 
 #include <dronecode_sdk/telemetry.h>
+#include <chrono>
+#include <map>
 #include "Signal.h"
 #include "EnemyDrone.h"
 #include "StlExpr.h"
@@ -51,6 +53,13 @@ namespace cdra {
                 "enemy_vel_east_m_s", "enemy_vel_north_m_s", "enemy_vel_down_m_s"};
 	std::vector<StlExpr*> stlExprs;
 
+        // Start of the current tick (before sensing) and the time sending
+        // an action to offboard takes (decaying maximum)
+        std::chrono::steady_clock::time_point tickStart;
+        std::chrono::steady_clock::duration actOverhead = std::chrono::steady_clock::duration::zero();
+        // Per-tick statistics (name -> tick -> value)
+        std::map<std::string, std::map<int, float>> tickStats;
+
     public:
         StateStore(std::shared_ptr<dronecode_sdk::Telemetry> telemetry,
 		   std::shared_ptr<EnemyDrone> enemyDrone);
@@ -61,6 +70,14 @@ namespace cdra {
         int currTick();
         // Returns the current signal
         Signal* getSignal();
+
+        // Records how long sending the current tick's action took
+        void recordActOverhead(std::chrono::steady_clock::duration overhead);
+        // Time by which coordination must be done for the action to be sent within
+        // TICK_DURATION of the tick start (no deadline before the first tick)
+        std::chrono::steady_clock::time_point deadline();
+        // Records a statistic of the current tick (written to run_data.json)
+        void recordStat(const std::string& name, float value);
 	
 	// Add StlExpr being used
 	void addStlExpr(StlExpr* stlExpr);
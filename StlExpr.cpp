@@ -22,6 +22,8 @@
  * DM20-0762
  */
 
+#include <algorithm>
+
 #include "Signal.h"
 #include "StlExpr.h"
 
@@ -40,6 +42,73 @@ namespace cdra {
     // by default, returns true
     return true;
   }
+  StlExpr* StlExpr::clone(){
+    return new StlExpr();
+  }
+  // By default, an expression is either fully determined by the committed
+  // history (and folded into a constant) or kept as is
+  StlExpr* StlExpr::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed)
+      return new Const(robustness(sig, t), sat(sig, t));
+    return clone();
+  }
+  void StlExpr::robustnessBatch(const StateBatch& states, float* out){
+    // by default, returns 0
+    std::fill(out, out + states.size(), 0.0f);
+  }
+
+  /**
+   * Constant (already evaluated) expression
+   */
+  Const::Const(float rob, bool satisfied) : rob(rob), satisfied(satisfied) {}
+  Const::~Const() {}
+  float Const::robustness(Signal *sig, int t){
+    return rob;
+  }
+  bool Const::sat(Signal *sig, int t){
+    return satisfied;
+  }
+  StlExpr* Const::clone(){
+    return new Const(rob, satisfied);
+  }
+  StlExpr* Const::partialEval(Signal *sig, int t, int committed){
+    return clone();
+  }
+  void Const::robustnessBatch(const StateBatch& states, float* out){
+    std::fill(out, out + states.size(), rob);
+  }
+  bool Const::robustnessBounds(const StateBounds& bounds, float& lower, float& upper){
+    lower = upper = rob;
+    return true;
+  }
+  bool Const::robustnessRange(float& lower, float& upper){
+    lower = upper = rob;
+    return true;
+  }
+  bool Const::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region){
+    if (!satisfied) region.setEmpty();
+    return true;
+  }
+
+  /*
+   * Shared partial evaluation of the window [first, last] of a temporal
+   * operator. Ticks whose value of "expr" only depends on the committed
+   * history are folded into "foldRob"/"foldSat"; the first tick that still
+   * depends on predicted values is returned (at most "last", so that the
+   * residual window keeps the availability check on "last").
+   */
+  static int foldWindow(StlExpr *expr, Signal *sig, int first, int last, int committed,
+			float &foldRob, bool &foldSat, bool &folded){
+    int split = committed - std::max(0, expr->horizon());
+    int firstFree = std::min(std::max(first, split), last);
+    for (int t2 = first; t2 < firstFree; t2++){
+      float r = expr->robustness(sig, t2);
+      if (!folded || r < foldRob) foldRob = r;
+      foldSat = foldSat && expr->sat(sig, t2);
+      folded = true;
+    }
+    return firstFree;
+  }
 
    /**
    * Atomic proposition in STL
@@ -54,6 +123,21 @@ namespace cdra {
     if (!sig->available(t)) return UNKNOWN_SAT;	
     return fun->prop(sig, t);
   }
+  StlExpr* Prop::clone(){
+    return new Prop(fun);
+  }
+  void Prop::robustnessBatch(const StateBatch& states, float* out){
+    fun->valueBatch(states, out);
+  }
+  bool Prop::robustnessBounds(const StateBounds& bounds, float& lower, float& upper){
+    return fun->valueBounds(bounds, lower, upper);
+  }
+  bool Prop::robustnessRange(float& lower, float& upper){
+    return fun->valueRange(lower, upper);
+  }
+  bool Prop::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region){
+    return fun->feasibleActions(sig, t, horizon, region);
+  }
 
   /**
    * Conjunction ("AND") in STL
@@ -76,6 +160,45 @@ namespace cdra {
     if (!sig->available(t)) return UNKNOWN_SAT;	
     return (left->sat(sig, t) && right->sat(sig, t));
   }
+  StlExpr* And::clone(){
+    return new And(left->clone(), right->clone());
+  }
+  int And::horizon(){
+    return std::max(0, std::max(left->horizon(), right->horizon()));
+  }
+  StlExpr* And::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed) return StlExpr::partialEval(sig, t, committed);
+    return new And(left->partialEval(sig, t, committed),
+		   right->partialEval(sig, t, committed));
+  }
+  void And::robustnessBatch(const StateBatch& states, float* out){
+    std::vector<float> other(states.size());
+    left->robustnessBatch(states, out);
+    right->robustnessBatch(states, other.data());
+    for (int i = 0; i < states.size(); i++){
+      out[i] = std::min(out[i], other[i]);
+    }
+  }
+  bool And::robustnessBounds(const StateBounds& bounds, float& lower, float& upper){
+    float otherLower, otherUpper;
+    if (!(left->robustnessBounds(bounds, lower, upper) &&
+	  right->robustnessBounds(bounds, otherLower, otherUpper))) return false;
+    lower = std::min(lower, otherLower);
+    upper = std::min(upper, otherUpper);
+    return true;
+  }
+  bool And::robustnessRange(float& lower, float& upper){
+    float otherLower, otherUpper;
+    if (!(left->robustnessRange(lower, upper) &&
+	  right->robustnessRange(otherLower, otherUpper))) return false;
+    lower = std::min(lower, otherLower);
+    upper = std::min(upper, otherUpper);
+    return true;
+  }
+  bool And::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region){
+    return left->feasibleActions(sig, t, horizon, region) &&
+      right->feasibleActions(sig, t, horizon, region);
+  }
 
   /**
    * Implication ("IMPLIES") in STL
@@ -94,6 +217,41 @@ namespace cdra {
     if (!sig->available(t)) return UNKNOWN_SAT;		
     return (!(left->sat(sig, t)) || right->sat(sig, t));
   }
+  StlExpr* Implies::clone(){
+    return new Implies(left->clone(), right->clone());
+  }
+  int Implies::horizon(){
+    return std::max(0, std::max(left->horizon(), right->horizon()));
+  }
+  StlExpr* Implies::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed) return StlExpr::partialEval(sig, t, committed);
+    return new Implies(left->partialEval(sig, t, committed),
+		       right->partialEval(sig, t, committed));
+  }
+  void Implies::robustnessBatch(const StateBatch& states, float* out){
+    std::vector<float> other(states.size());
+    left->robustnessBatch(states, out);
+    right->robustnessBatch(states, other.data());
+    for (int i = 0; i < states.size(); i++){
+      out[i] = std::max(-1.0f*out[i], other[i]);
+    }
+  }
+  bool Implies::robustnessBounds(const StateBounds& bounds, float& lower, float& upper){
+    float leftLower, leftUpper;
+    if (!(left->robustnessBounds(bounds, leftLower, leftUpper) &&
+	  right->robustnessBounds(bounds, lower, upper))) return false;
+    lower = std::max(-leftUpper, lower);
+    upper = std::max(-leftLower, upper);
+    return true;
+  }
+  bool Implies::robustnessRange(float& lower, float& upper){
+    float leftLower, leftUpper;
+    if (!(left->robustnessRange(leftLower, leftUpper) &&
+	  right->robustnessRange(lower, upper))) return false;
+    lower = std::max(-leftUpper, lower);
+    upper = std::max(-leftLower, upper);
+    return true;
+  }
   
   /**
    * Negation ("NOT") in STL
@@ -110,13 +268,45 @@ namespace cdra {
     if (!sig->available(t)) return UNKNOWN_SAT;		
     return !(expr->sat(sig, t));
   }
+  StlExpr* Not::clone(){
+    return new Not(expr->clone());
+  }
+  int Not::horizon(){
+    return std::max(0, expr->horizon());
+  }
+  StlExpr* Not::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed) return StlExpr::partialEval(sig, t, committed);
+    return new Not(expr->partialEval(sig, t, committed));
+  }
+  void Not::robustnessBatch(const StateBatch& states, float* out){
+    expr->robustnessBatch(states, out);
+    for (int i = 0; i < states.size(); i++){
+      out[i] = -out[i];
+    }
+  }
+  bool Not::robustnessBounds(const StateBounds& bounds, float& lower, float& upper){
+    float exprLower, exprUpper;
+    if (!expr->robustnessBounds(bounds, exprLower, exprUpper)) return false;
+    lower = -exprUpper;
+    upper = -exprLower;
+    return true;
+  }
+  bool Not::robustnessRange(float& lower, float& upper){
+    float exprLower, exprUpper;
+    if (!expr->robustnessRange(exprLower, exprUpper)) return false;
+    lower = -exprUpper;
+    upper = -exprLower;
+    return true;
+  }
 
   /**
    * Globally ("G") in STL
    */
-  Global::Global(StlExpr *expr, int begin, int end) : expr(expr), begin(begin), end(end) {}
+  Global::Global(StlExpr *expr, int begin, int end, StlExpr *folded) :
+    expr(expr), begin(begin), end(end), folded(folded) {}
   Global::~Global() {
     delete expr;
+    delete folded;
   }
   float Global::robustness(Signal *sig, int t){
     if (!(sig->available(t + begin) && sig->available(t + end))) return UNKNOWN_ROB;
@@ -126,27 +316,54 @@ namespace cdra {
       float r = expr->robustness(sig, t2);
       if (r < min) min = r;
     }
+    if (folded) min = std::min(min, folded->robustness(sig, t));
     return min;
   }
   // Semantics of G[a,b] \phi:
   // \forall t' \in [t + begin, t + end] . (sig, t') \sat \phi
   bool Global::sat(Signal *sig, int t){
     if (!(sig->available(t + begin) && sig->available(t + end))) return UNKNOWN_SAT;	
+    if (folded && !folded->sat(sig, t)) return false;
     
     for (int t2 = t + begin; t2 <= t + end; t2++){
       if (!expr->sat(sig, t2)) return false;
     }
     return true;
   }
+  StlExpr* Global::clone(){
+    return new Global(expr->clone(), begin, end, folded ? folded->clone() : nullptr);
+  }
+  int Global::horizon(){
+    return end + std::max(0, expr->horizon());
+  }
+  StlExpr* Global::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed) return StlExpr::partialEval(sig, t, committed);
+    // The window start is committed but unavailable: never known
+    if (t + begin < committed && !sig->available(t + begin))
+      return new Const(UNKNOWN_ROB, UNKNOWN_SAT);
+
+    float foldRob = 0;
+    bool foldSat = true, isFolded = false;
+    if (folded) {
+      foldRob = folded->robustness(sig, t);
+      foldSat = folded->sat(sig, t);
+      isFolded = true;
+    }
+    int firstFree = foldWindow(expr, sig, t + begin, t + end, committed, foldRob, foldSat, isFolded);
+    if (!isFolded) return clone();
+    return new Global(expr->clone(), firstFree - t, end, new Const(foldRob, foldSat));
+  }
 
   
   
   /**
    * Globally ("G") in STL
    */
-  PastGlobal::PastGlobal(StlExpr *expr, int begin, int end) : expr(expr), begin(begin), end(end) {}
+  PastGlobal::PastGlobal(StlExpr *expr, int begin, int end, StlExpr *folded) :
+    expr(expr), begin(begin), end(end), folded(folded) {}
   PastGlobal::~PastGlobal() {
     delete expr;
+    delete folded;
   }
   float PastGlobal::robustness(Signal *sig, int t){
     if (!(sig->available(t - begin) && sig->available(t - end))) return UNKNOWN_ROB;
@@ -156,18 +373,47 @@ namespace cdra {
       float r = expr->robustness(sig, t2);
       if (r < min) min = r;
     }
+    if (folded) min = std::min(min, folded->robustness(sig, t));
     return min;
   }
   // Semantics of G[a,b] \phi:
   // \forall t' \in [t + begin, t + end] . (sig, t') \sat \phi
   bool PastGlobal::sat(Signal *sig, int t){
     if (!(sig->available(t - begin) && sig->available(t - end))) return UNKNOWN_SAT;
+    if (folded && !folded->sat(sig, t)) return false;
 	
     for (int t2 = t - begin; t2 <= t - end; t2++){
       if (!expr->sat(sig, t2)) return false;
     }
     return true;
   }
+  StlExpr* PastGlobal::clone(){
+    return new PastGlobal(expr->clone(), begin, end, folded ? folded->clone() : nullptr);
+  }
+  int PastGlobal::horizon(){
+    return -end + std::max(0, expr->horizon());
+  }
+  StlExpr* PastGlobal::partialEval(Signal *sig, int t, int committed){
+    if (t + horizon() < committed) return StlExpr::partialEval(sig, t, committed);
+    // The window start is committed but unavailable: never known
+    if (t - begin < committed && !sig->available(t - begin))
+      return new Const(UNKNOWN_ROB, UNKNOWN_SAT);
+
+    float foldRob = 0;
+    bool foldSat = true, isFolded = false;
+    if (folded) {
+      foldRob = folded->robustness(sig, t);
+      foldSat = folded->sat(sig, t);
+      isFolded = true;
+    }
+    int firstFree = foldWindow(expr, sig, t - begin, t - end, committed, foldRob, foldSat, isFolded);
+    if (!isFolded) return clone();
+    // Only the current tick is left in the window (e.g., PG_[t-n,t]):
+    // the residual is the folded history and the sub-expression at t
+    if (firstFree == t && end == 0)
+      return new And(new Const(foldRob, foldSat), expr->partialEval(sig, t, committed));
+    return new PastGlobal(expr->clone(), t - firstFree, end, new Const(foldRob, foldSat));
+  }
   
   
 }
@@ -27,6 +27,8 @@
 
 #include "Signal.h"
 #include "SigFun.h"
+#include "StateBatch.h"
+#include <limits>
 
 namespace cdra {
 
@@ -38,12 +40,68 @@ namespace cdra {
     const bool  UNKNOWN_SAT = 1;
     const float UNKNOWN_ROB = 0;     
   public:
+    // Horizon of an expression that reads no signal value at all
+    static const int NO_HORIZON = std::numeric_limits<int>::min() / 2;
+
     StlExpr();
     virtual ~StlExpr();
     virtual float robustness(Signal *sig, int t);
     virtual bool sat(Signal *sig, int t);
     virtual std::string exprStr() {return "T";};
     virtual std::string generalStr() { return "Propname"; };
+    // Returns a deep copy of this expression (signal functions are shared)
+    virtual StlExpr* clone();
+    // Largest tick offset (relative to t) read when evaluating at tick t
+    virtual int horizon() { return NO_HORIZON; };
+    /**
+     * Partial evaluation against a committed history.
+     * "sig" holds the committed ticks [0, committed); every part of this
+     * expression that only reads those ticks is folded into a constant.
+     * The returned residual (owned by the caller) has the same robustness
+     * and satisfaction at tick t as this expression for any signal that
+     * extends the committed history.
+     */
+    virtual StlExpr* partialEval(Signal *sig, int t, int committed);
+    // Returns true iff robustnessBatch can evaluate this expression, i.e.,
+    // it reads no tick other than the one it is evaluated at
+    virtual bool batchable() { return false; };
+    // Robustness for each state of the batch, where the batch holds
+    // alternative signal values at the tick being evaluated
+    virtual void robustnessBatch(const StateBatch& states, float* out);
+    // Restricts "region" to the actions (held for "horizon" seconds from the
+    // state at tick t) after which this expression is satisfied, for
+    // expressions that read only that next tick (see SigFun::feasibleActions).
+    // Returns false if the region of this expression cannot be described.
+    virtual bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) { return false; };
+    // Bounds the robustness over every state within "bounds" at the tick
+    // being evaluated, for batchable expressions (see SigFun::valueBounds).
+    // Returns false if this expression cannot be bounded.
+    virtual bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper) { return false; };
+    // Bounds the robustness over every signal whatsoever (from the range the
+    // signal functions normalize to, see SigFun::valueRange).
+    // Returns false if this expression cannot be bounded.
+    virtual bool robustnessRange(float& lower, float& upper) { return false; };
+  };
+
+  /**
+   * Constant (already evaluated) expression; produced by partial evaluation
+   */
+  class Const : public StlExpr {
+    float rob;
+    bool satisfied;
+  public:
+    Const(float rob, bool satisfied);
+    virtual ~Const();
+    float robustness(Signal *sig, int t);
+    bool sat(Signal *sig, int t);
+    std::string exprStr() { return std::to_string(rob); };
+    StlExpr* clone();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
+    bool batchable() { return true; };
+    void robustnessBatch(const StateBatch& states, float* out);
+    bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper);
+    bool robustnessRange(float& lower, float& upper);
+    bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
   };
 
   /**
@@ -59,6 +117,13 @@ namespace cdra {
     bool sat(Signal *sig, int t);
     std::string exprStr() { return "Prop(" + fun->propStr() + ")";};
     std::string generalStr() { return fun->enforcer_name(); };
+    StlExpr* clone();
+    int horizon() { return 0; };
+    bool batchable() { return true; };
+    void robustnessBatch(const StateBatch& states, float* out);
+    bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper);
+    bool robustnessRange(float& lower, float& upper);
+    bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
   };
 
   /**
@@ -73,6 +138,14 @@ namespace cdra {
     bool sat(Signal *sig, int t);
     std::string exprStr() {
       return "(" + left->exprStr() + ") AND (" + right->exprStr() + ")";};
+    StlExpr* clone();
+    int horizon();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
+    bool batchable() { return left->batchable() && right->batchable(); };
+    void robustnessBatch(const StateBatch& states, float* out);
+    bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper);
+    bool robustnessRange(float& lower, float& upper);
+    bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
   };
 
   /**
@@ -86,6 +159,13 @@ namespace cdra {
     float robustness(Signal *sig, int t);
     bool sat(Signal *sig, int t);
     std::string exprStr() { return "!(" + expr->exprStr() + ")";};
+    StlExpr* clone();
+    int horizon();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
+    bool batchable() { return expr->batchable(); };
+    void robustnessBatch(const StateBatch& states, float* out);
+    bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper);
+    bool robustnessRange(float& lower, float& upper);
   };
 
   
@@ -95,14 +175,18 @@ namespace cdra {
   class Global : public StlExpr {
     StlExpr *expr;   
     int begin, end; // begin & end time bound
+    StlExpr *folded; // partially evaluated prefix of the window (may be null)
   public:
-    Global(StlExpr *expr, int begin, int end);
+    Global(StlExpr *expr, int begin, int end, StlExpr *folded = nullptr);
     virtual ~Global();
     float robustness(Signal *sig, int t);
     bool sat(Signal *sig, int t);
     std::string exprStr() {
       return "G_[t+" + std::to_string(begin) + ",t+" + std::to_string(end) + "]("
 	+ expr->exprStr() + ")";};
+    StlExpr* clone();
+    int horizon();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
   };
 
    /**
@@ -116,6 +200,13 @@ namespace cdra {
     float robustness(Signal *sig, int t);
     bool sat(Signal *sig, int t);
     std::string exprStr() { return "(" + left->exprStr() + ") => (" + right->exprStr() + ")";};
+    StlExpr* clone();
+    int horizon();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
+    bool batchable() { return left->batchable() && right->batchable(); };
+    void robustnessBatch(const StateBatch& states, float* out);
+    bool robustnessBounds(const StateBounds& bounds, float& lower, float& upper);
+    bool robustnessRange(float& lower, float& upper);
   };
 
     /**
@@ -124,13 +215,17 @@ namespace cdra {
   class PastGlobal : public StlExpr {
     StlExpr *expr;   
     int begin, end; // begin & end time bound
+    StlExpr *folded; // partially evaluated prefix of the window (may be null)
   public:
-    PastGlobal(StlExpr *expr, int begin, int end);
+    PastGlobal(StlExpr *expr, int begin, int end, StlExpr *folded = nullptr);
     virtual ~PastGlobal();
     float robustness(Signal *sig, int t);
     bool sat(Signal *sig, int t);
     std::string exprStr() { return "PG_[t-" + std::to_string(begin) + ",t-" + std::to_string(end) + "](" +
 	expr->exprStr() + ")";};
+    StlExpr* clone();
+    int horizon();
+    StlExpr* partialEval(Signal *sig, int t, int committed);
   };
 
   
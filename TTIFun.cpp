@@ -24,10 +24,12 @@
 
 #include "TTIFun.h"
 #include "Signal.h"
+#include "SigKernels.h"
 #include "DroneUtil.h"
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <math.h>
 
 using namespace dronecode_sdk;
@@ -74,6 +76,106 @@ namespace cdra {
     return value(sig, sig->length() - 1);
   }
 
+  void TTIFun::valueBatch(const StateBatch& states, float* out) {
+    int n = states.size();
+    kernels::tti(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST),
+		 states.data(StateBatch::POS_DOWN), states.data(StateBatch::VEL_NORTH),
+		 states.data(StateBatch::VEL_EAST), states.data(StateBatch::VEL_DOWN),
+		 n, lowerx, upperx, lowery, uppery, lowerz, upperz, out);
+    for (int i = 0; i < n; i++) {
+      out[i] -= safeThreshold;
+    }
+    normalizeBatch(out, n);
+  }
+
+  /* Quotient of computeTTI at a velocity "den" that may be 0, standing for its limit
+   * as the velocity tends to 0 from the "side" (+1 or -1) of its case */
+  static float quotient(float num, float den, float side) {
+    if(den != 0) return num / den;
+    if(num == 0) return 0;
+    return (num > 0) == (side > 0) ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+  }
+
+  /* Bounds [lo, hi] of one axis' term of computeTTI (1000 if none) over the positions
+   * [pos_lo, pos_hi] and velocities [vel_lo, vel_hi], with the box [lower, upper].
+   * Each case of computeTTI (outside below/above or inside the box, by the sign of the
+   * velocity) is monotone in both the position and the velocity, so over its part of
+   * the domain it is bounded by its values at two opposite corners (or their limits) */
+  static void axisBounds(float lower, float upper, float pos_lo, float pos_hi,
+			 float vel_lo, float vel_hi, float& lo, float& hi) {
+    const float NONE = 1000.0f;
+    lo = std::numeric_limits<float>::infinity();
+    hi = -lo;
+    // Case over [p0, p1] x [v0, v1], increasing (or decreasing) in the position and velocity
+    auto cover = [&](float p0, float p1, float v0, float v1, bool increasing, float (*f)(float, float, float, float)) {
+      float top = increasing ? f(p1, v1, lower, upper) : f(p0, v0, lower, upper);
+      float bottom = increasing ? f(p0, v0, lower, upper) : f(p1, v1, lower, upper);
+      lo = std::min(lo, std::min(bottom, NONE));
+      hi = std::max(hi, std::min(top, NONE));
+    };
+    if(pos_lo <= lower) { // Below
+      float p1 = std::min(pos_hi, lower);
+      if(vel_lo <= 0) cover(pos_lo, p1, vel_lo, std::min(vel_hi, 0.0f), true,
+			    [](float p, float v, float l, float u) { return (p - l) + v; });
+      if(vel_hi > 0) cover(pos_lo, p1, std::max(vel_lo, 0.0f), vel_hi, true,
+			   [](float p, float v, float l, float u) { return quotient(p - l, v, 1); });
+    }
+    if(pos_hi >= upper) { // Above
+      float p0 = std::max(pos_lo, upper);
+      if(vel_lo < 0) cover(p0, pos_hi, vel_lo, std::min(vel_hi, 0.0f), true,
+			   [](float p, float v, float l, float u) { return quotient(u - p, v, -1); });
+      if(vel_hi >= 0) cover(p0, pos_hi, std::max(vel_lo, 0.0f), vel_hi, false,
+			    [](float p, float v, float l, float u) { return (u - p) - v; });
+    }
+    if(pos_lo < upper && pos_hi > lower) { // In boundary
+      float p0 = std::max(pos_lo, lower), p1 = std::min(pos_hi, upper);
+      if(vel_lo < 0) cover(p0, p1, vel_lo, std::min(vel_hi, 0.0f), true,
+			   [](float p, float v, float l, float u) { return quotient(p - l, -v, 1); });
+      if(vel_hi > 0) cover(p0, p1, std::max(vel_lo, 0.0f), vel_hi, false,
+			   [](float p, float v, float l, float u) { return quotient(u - p, v, 1); });
+      if(vel_lo <= 0 && vel_hi >= 0) {
+	lo = std::min(lo, NONE);
+	hi = std::max(hi, NONE);
+      }
+    }
+  }
+
+  bool TTIFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+    // computeTTI is the minimum of the axes' terms (and 1000)
+    float lo[3], hi[3];
+    axisBounds(lowerx, upperx, bounds.lower[StateBatch::POS_NORTH], bounds.upper[StateBatch::POS_NORTH],
+	       bounds.lower[StateBatch::VEL_NORTH], bounds.upper[StateBatch::VEL_NORTH], lo[0], hi[0]);
+    axisBounds(lowery, uppery, bounds.lower[StateBatch::POS_EAST], bounds.upper[StateBatch::POS_EAST],
+	       bounds.lower[StateBatch::VEL_EAST], bounds.upper[StateBatch::VEL_EAST], lo[1], hi[1]);
+    axisBounds(lowerz, upperz, -bounds.upper[StateBatch::POS_DOWN], -bounds.lower[StateBatch::POS_DOWN],
+	       -bounds.upper[StateBatch::VEL_DOWN], -bounds.lower[StateBatch::VEL_DOWN], lo[2], hi[2]);
+    lower = normalizeValue(std::min(std::min(lo[0], lo[1]), lo[2]) - safeThreshold);
+    upper = normalizeValue(std::min(std::min(hi[0], hi[1]), hi[2]) - safeThreshold);
+    return true;
+  }
+
+  bool TTIFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+    float pos[3] = { sig->value("pos_north_m", t), sig->value("pos_east_m", t),
+		     -sig->value("pos_down_m", t) };
+    float lower[3] = { lowerx, lowery, lowerz };
+    float upper[3] = { upperx, uppery, upperz };
+    // Direction of each axis in NED (z bounds are "up")
+    float axes[3][3] = { {1, 0, 0}, {0, 1, 0}, {0, 0, -1} };
+
+    for (int a = 0; a < 3; a++) {
+      // Per axis, after "horizon" the position p' = p + v*horizon must be
+      // within the bounds, and the time to reach the boundary ahead
+      // (bound - p') / v must be at least the safe threshold, i.e.,
+      // v*(horizon + safeThreshold) <= upper - p (and likewise for lower)
+      float up_room = upper[a] - pos[a];
+      float lo_room = lower[a] - pos[a];
+      float v_max = std::min(up_room / (horizon + safeThreshold), up_room / horizon);
+      float v_min = std::max(lo_room / (horizon + safeThreshold), lo_room / horizon);
+      region.addSlab(axes[a][0], axes[a][1], axes[a][2], v_min, v_max);
+    }
+    return true;
+  }
+
   bool TTIFun::closeToXBoundary(float pos_east_m, float pos_north_m, float pos_down_m,
                                 float vel_east_m_s, float vel_north_m_s, float vel_down_m_s) const {
     return
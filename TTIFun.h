@@ -65,6 +65,12 @@ namespace cdra {
     bool prop(Signal *sig, int t);
     // returns true iff TTI at tick "t" within safe threshold
     bool prop(Signal *sig);
+    // returns the TTI for each state of the batch
+    void valueBatch(const StateBatch& states, float* out);
+    // returns the box of velocities that keep the TTI above the safe threshold
+    bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+    // bounds the TTI over the states within "bounds" (per axis, see TTIFun.cpp)
+    bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
     std::string propStr() { return "tti - " + std::to_string(safeThreshold) +  " >= 0"; };
     std::string enforcer_name() { return "Boundary";};
     bool closeToXBoundary(float pos_east_m, float pos_north_m, float pos_down_m,
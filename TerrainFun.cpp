@@ -0,0 +1,105 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "Signal.h"
+#include "TerrainFun.h"
+#include "DroneUtil.h"
+#include <cmath>
+#include <iostream>
+
+namespace cdra {
+
+  TerrainFun::TerrainFun(std::shared_ptr<Heightmap> terrain, float safeDist) :
+    safeDist(safeDist), terrain(terrain) {
+
+    /* Same range as DTGFun */
+    minValue = 0 - safeDist;
+    maxValue = safeDist*2 - safeDist;
+
+    std::cout << "TMax: " << std::to_string(maxValue) <<  std::endl;
+    std::cout << "TMin: " << std::to_string(minValue) << std::endl;
+    std::cout << "TMid: " << std::to_string(-minValue / (maxValue - minValue))
+	      << std::endl;
+  }
+
+  TerrainFun::~TerrainFun() {
+  }
+
+  float TerrainFun::value(Signal *sig, int t) {
+    float pos_north_m = sig->value("pos_north_m", t);
+    float pos_east_m  = sig->value("pos_east_m" , t);
+    float pos_down_m  = sig->value("pos_down_m" , t);
+
+    // Note: down = -z
+    float dtg = -pos_down_m - terrain->height(pos_north_m, pos_east_m);
+    return normalizeValue(dtg - safeDist);
+  }
+
+  float TerrainFun::value(Signal *sig) {
+    return value(sig, sig->length() - 1);
+  }
+
+  void TerrainFun::valueBatch(const StateBatch& states, float* out) {
+    int n = states.size();
+    const float* pos_down = states.data(StateBatch::POS_DOWN);
+    terrain->heights(states.data(StateBatch::POS_NORTH), states.data(StateBatch::POS_EAST), n, out);
+    for (int i = 0; i < n; i++) {
+      out[i] = -pos_down[i] - out[i] - safeDist;
+    }
+    normalizeBatch(out, n);
+  }
+
+  bool TerrainFun::valueBounds(const StateBounds& bounds, float& lower, float& upper) {
+    float low, high;
+    terrain->heightRange(bounds.lower[StateBatch::POS_NORTH], bounds.lower[StateBatch::POS_EAST],
+			 bounds.upper[StateBatch::POS_NORTH], bounds.upper[StateBatch::POS_EAST], low, high);
+    lower = normalizeValue(-bounds.upper[StateBatch::POS_DOWN] - high - safeDist);
+    upper = normalizeValue(-bounds.lower[StateBatch::POS_DOWN] - low  - safeDist);
+    return true;
+  }
+
+  bool TerrainFun::feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region) {
+    float pos_north_m = sig->value("pos_north_m", t);
+    float pos_east_m  = sig->value("pos_east_m" , t);
+    float pos_down_m  = sig->value("pos_down_m" , t);
+
+    // Highest ground the drone can be over after the horizon
+    float reach = droneutil::MAX_DRONE_SPEED * horizon;
+    float low, high;
+    terrain->heightRange(pos_north_m - reach, pos_east_m - reach,
+			 pos_north_m + reach, pos_east_m + reach, low, high);
+    region.addHalfSpace(0, 0, horizon, -pos_down_m - high - safeDist);
+    return true;
+  }
+
+  bool TerrainFun::prop(Signal *sig, int t) {
+    float val = value(sig, t);
+    return (val >= 0);
+  }
+
+  bool TerrainFun::prop(Signal *sig) {
+    float val = value(sig);
+    return (val >= 0);
+  }
+}
@@ -0,0 +1,70 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_TERRAINFUN_H
+#define MISSIONAPP_TERRAINFUN_H
+
+#include <memory>
+#include "Signal.h"
+#include "SigFun.h"
+#include "Heightmap.h"
+
+namespace cdra {
+
+    /**
+     * Terrain-aware Distance to Ground (DTG) function
+     * Like DTGFun, but the ground altitude under the drone is looked up
+     * in a heightmap instead of assuming flat ground
+     */
+    class TerrainFun :  public SigFun {
+
+        const float safeDist;
+        std::shared_ptr<Heightmap> terrain;
+
+    public:
+        TerrainFun(std::shared_ptr<Heightmap> terrain, float safeDist);
+        virtual ~TerrainFun();
+        // returns the DTG at tick "t"
+        float value(Signal *sig, int t);
+        // returns the current DTG
+        float value(Signal *sig);
+        // returns true iff DTG at tick "t" within safe threshold
+        bool prop(Signal *sig, int t);
+        // returns true iff current DTG within safe threshold
+        bool prop(Signal *sig);
+        // returns the DTG for each state of the batch
+        void valueBatch(const StateBatch& states, float* out);
+        // returns the bound on the descent rate that keeps the DTG above the
+        // safe distance over the highest ground within reach
+        bool feasibleActions(Signal *sig, int t, float horizon, ActionRegion& region);
+        // bounds the DTG by the altitudes within "bounds" and the terrain under them
+        bool valueBounds(const StateBounds& bounds, float& lower, float& upper);
+        std::string propStr() { return "dist-to-terrain - " + std::to_string(safeDist) +  " >= 0"; };
+        std::string enforcer_name() { return "Flight";};
+        Heightmap* getTerrain() { return terrain.get(); };
+    };
+
+}
+
+#endif //MISSIONAPP_TERRAINFUN_H
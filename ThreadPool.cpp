@@ -0,0 +1,128 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace cdra {
+
+  ThreadPool::ThreadPool(int workers) : queued(0), pending(0) {
+    workers = std::max(workers, 1);
+    for (int w = 0; w < workers; w++) {
+      queues.emplace_back(new Queue());
+    }
+    for (int w = 1; w < workers; w++) {
+      threads.emplace_back(&ThreadPool::run, this, w);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> guard(stateLock);
+      stopping = true;
+    }
+    workReady.notify_all();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  bool ThreadPool::take(int worker, int& task) {
+    if (queued.load() == 0) {
+      return false;
+    }
+    int n = queues.size();
+    for (int i = 0; i < n; i++) {
+      // Own queue from the back, the others' from the front
+      Queue& q = *queues[(worker + i) % n];
+      std::lock_guard<std::mutex> guard(q.lock);
+      if (!q.tasks.empty()) {
+	if (i == 0) {
+	  task = q.tasks.back();
+	  q.tasks.pop_back();
+	} else {
+	  task = q.tasks.front();
+	  q.tasks.pop_front();
+	}
+	queued--;
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void ThreadPool::run(int worker) {
+    int task;
+    while (true) {
+      {
+	std::unique_lock<std::mutex> guard(stateLock);
+	workReady.wait(guard, [this] { return stopping || queued.load() > 0; });
+	if (stopping) {
+	  return;
+	}
+      }
+      while (take(worker, task)) {
+	body(task, worker);
+	if (--pending == 0) {
+	  std::lock_guard<std::mutex> guard(stateLock);
+	  workDone.notify_all();
+	}
+      }
+    }
+  }
+
+  void ThreadPool::parallelFor(int n, const std::function<void(int, int)>& body) {
+    if (threads.empty() || n <= 1) {
+      for (int i = 0; i < n; i++) {
+	body(i, 0);
+      }
+      return;
+    }
+
+    this->body = body;
+    pending = n;
+    int workers = queues.size();
+    for (int i = 0; i < n; i++) {
+      Queue& q = *queues[i % workers];
+      std::lock_guard<std::mutex> guard(q.lock);
+      q.tasks.push_back(i);
+    }
+    {
+      std::lock_guard<std::mutex> guard(stateLock);
+      queued = n;
+    }
+    workReady.notify_all();
+
+    // The calling thread works too
+    int task;
+    while (take(0, task)) {
+      body(task, 0);
+      pending--;
+    }
+    std::unique_lock<std::mutex> guard(stateLock);
+    workDone.wait(guard, [this] { return pending.load() == 0; });
+  }
+
+}
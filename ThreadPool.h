@@ -0,0 +1,84 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_THREADPOOL_H
+#define MISSIONAPP_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A persistent pool of worker threads with work stealing.
+   * Each worker (and the calling thread, worker 0) has its own task
+   * queue; tasks are dealt round-robin to the queues, each worker takes
+   * tasks from the back of its own queue and, once it is empty, steals
+   * from the front of the others, so uneven tasks still keep every
+   * worker busy.
+   * Only one parallelFor may run at a time.
+   */
+  class ThreadPool {
+    // A task is the index of the loop iteration to run
+    struct Queue {
+      std::mutex lock;
+      std::deque<int> tasks;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker
+    std::function<void(int, int)> body;         // of the running parallelFor
+
+    std::mutex stateLock;
+    std::condition_variable workReady, workDone;
+    std::atomic<int> queued;   // tasks not taken yet
+    std::atomic<int> pending;  // tasks not finished yet
+    bool stopping = false;
+
+    // Takes a task (own queue first, then stealing); false if none is left
+    bool take(int worker, int& task);
+    void run(int worker);
+
+  public:
+    // Pool of "workers" workers, including the calling thread
+    ThreadPool(int workers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return queues.size(); };
+    // Runs body(i, worker) for every i in [0, n) and waits for all of them;
+    // "worker" in [0, size()) identifies the thread, e.g., to use its own buffers
+    void parallelFor(int n, const std::function<void(int, int)>& body);
+  };
+
+}
+
+#endif //MISSIONAPP_THREADPOOL_H
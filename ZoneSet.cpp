@@ -0,0 +1,171 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#include "ZoneSet.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <sstream>
+
+namespace cdra {
+
+  // Grid cells per zone (more cells = fewer zones checked per query)
+  static const int CELLS_PER_ZONE = 4;
+  static const int MAX_CELLS = 1 << 20;
+
+  bool ZoneSet::load(const std::string& fname) {
+    std::ifstream infile(fname);
+    if (!infile) {
+      std::cerr << "Cannot open zone file: " << fname << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(infile, line)) {
+      line = line.substr(0, line.find('#'));
+      std::istringstream iss(line);
+      Zone z;
+      if (!(iss >> z.lowerx)) {
+	continue; // empty line
+      }
+      if (!(iss >> z.lowery >> z.upperx >> z.uppery >> z.goal_z >> z.acceptable_range) ||
+	  z.lowerx > z.upperx || z.lowery > z.uppery || z.acceptable_range <= 0) {
+	std::cerr << "Bad zone line: " << line << std::endl;
+	return false;
+      }
+      add(z);
+    }
+    build();
+    std::cout << "Zones: " << zones.size() << " (" << rows << "x" << cols << " grid)" << std::endl;
+    return !zones.empty();
+  }
+
+  int ZoneSet::row(float x) const {
+    return std::min(std::max((int)floorf((x - minx) / cellSize), 0), rows - 1);
+  }
+
+  int ZoneSet::col(float y) const {
+    return std::min(std::max((int)floorf((y - miny) / cellSize), 0), cols - 1);
+  }
+
+  void ZoneSet::build() {
+    rows = cols = 0;
+    cellStart.assign(1, 0);
+    cellZones.clear();
+    if (zones.empty()) {
+      return;
+    }
+
+    float maxx = zones[0].upperx, maxy = zones[0].uppery;
+    minx = zones[0].lowerx;
+    miny = zones[0].lowery;
+    for (auto& z : zones) {
+      minx = std::min(minx, z.lowerx);
+      miny = std::min(miny, z.lowery);
+      maxx = std::max(maxx, z.upperx);
+      maxy = std::max(maxy, z.uppery);
+    }
+
+    // Square cells, about CELLS_PER_ZONE of them per zone
+    float width = std::max(maxx - minx, 1e-3f), height = std::max(maxy - miny, 1e-3f);
+    int target = std::min((int)zones.size() * CELLS_PER_ZONE, MAX_CELLS);
+    cellSize = sqrtf(width * height / target);
+    rows = std::max(1, (int)ceilf(width / cellSize));
+    cols = std::max(1, (int)ceilf(height / cellSize));
+    while ((long)rows * cols > MAX_CELLS) {
+      cellSize *= 2;
+      rows = std::max(1, (int)ceilf(width / cellSize));
+      cols = std::max(1, (int)ceilf(height / cellSize));
+    }
+
+    // Two passes: count the zones of each cell, then fill them in order
+    std::vector<int> count(rows * cols + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      std::vector<int> next;
+      if (pass == 1) {
+	cellStart.assign(rows * cols + 1, 0);
+	for (int c = 0; c < rows * cols; c++) {
+	  cellStart[c + 1] = cellStart[c] + count[c];
+	}
+	cellZones.resize(cellStart.back());
+	next.assign(cellStart.begin(), cellStart.end() - 1);
+      }
+      for (int i = 0; i < (int)zones.size(); i++) {
+	const Zone& z = zones[i];
+	for (int r = row(z.lowerx); r <= row(z.upperx); r++) {
+	  for (int c = col(z.lowery); c <= col(z.uppery); c++) {
+	    if (pass == 0) {
+	      count[r * cols + c]++;
+	    } else {
+	      cellZones[next[r * cols + c]++] = i;
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  int ZoneSet::find(float x, float y) const {
+    if (rows == 0) {
+      return -1;
+    }
+    int cell = row(x) * cols + col(y);
+    for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+      const Zone& z = zones[cellZones[k]];
+      if (x >= z.lowerx && x <= z.upperx && y >= z.lowery && y <= z.uppery) {
+	return cellZones[k];
+      }
+    }
+    return -1;
+  }
+
+  void ZoneSet::find(const float* x, const float* y, int n, int* out) const {
+    for (int i = 0; i < n; i++) {
+      out[i] = find(x[i], y[i]);
+    }
+  }
+
+  void ZoneSet::overlapping(float lowerx, float lowery, float upperx, float uppery,
+			    std::vector<int>& out) const {
+    out.clear();
+    if (rows == 0) {
+      return;
+    }
+    for (int r = row(lowerx); r <= row(upperx); r++) {
+      for (int c = col(lowery); c <= col(uppery); c++) {
+	int cell = r * cols + c;
+	for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+	  const Zone& z = zones[cellZones[k]];
+	  if (z.lowerx <= upperx && z.upperx >= lowerx && z.lowery <= uppery && z.uppery >= lowery) {
+	    out.push_back(cellZones[k]);
+	  }
+	}
+      }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+  }
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+#ifndef MISSIONAPP_ZONESET_H
+#define MISSIONAPP_ZONESET_H
+
+#include <string>
+#include <vector>
+
+namespace cdra {
+
+  /**
+   * A set of rectangular zones (north/east), each with its own altitude
+   * band, indexed by a uniform grid so that a point query only checks the
+   * zones overlapping one grid cell.
+   *
+   * File format: one zone per line ('#' starts a comment)
+   *   <lowerx> <lowery> <upperx> <uppery> <elevation> <acceptable range>
+   * with x = north, y = east (m), as in ReconFun.
+   * Where zones overlap, the one listed first is used.
+   */
+  class ZoneSet {
+  public:
+    struct Zone {
+      float lowerx, lowery, upperx, uppery;
+      float goal_z, acceptable_range;
+    };
+
+  private:
+    std::vector<Zone> zones;
+    // Grid over the bounding box of the zones; cell c holds the indices
+    // cellZones[cellStart[c], cellStart[c+1]) in increasing order
+    float minx = 0, miny = 0, cellSize = 1;
+    int rows = 0, cols = 0;
+    std::vector<int> cellStart, cellZones;
+
+    int row(float x) const;
+    int col(float y) const;
+
+  public:
+    // Reads a zone file and builds the index; returns false on error
+    bool load(const std::string& fname);
+    void add(const Zone& zone) { zones.push_back(zone); };
+    // (Re)builds the index; needed after adding zones
+    void build();
+
+    int size() const { return zones.size(); };
+    const Zone& zone(int i) const { return zones[i]; };
+    // Index of the zone containing (x, y), or -1 if none does
+    int find(float x, float y) const;
+    // Zone index (or -1) for each of "n" positions
+    void find(const float* x, const float* y, int n, int* out) const;
+    // Indices of the zones overlapping a box, in increasing order
+    void overlapping(float lowerx, float lowery, float upperx, float uppery,
+		     std::vector<int>& out) const;
+  };
+
+}
+
+#endif //MISSIONAPP_ZONESET_H
@@ -0,0 +1,137 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+/*
+ * Checks the approximate penalty curve of the batch kernels (see
+ * SigKernels.h) over every float in [-1, 0]: its absolute error against
+ * the curve computed in double precision must be at most
+ * PENALTY_CURVE_MAX_ERROR, and the AVX2 kernels (if the CPU has them)
+ * must compute exactly the same values as the scalar ones, for the curve
+ * and for the normalization built on it.
+ * Exits with failure otherwise; "make check" runs it.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <math.h>
+#include <thread>
+#include <vector>
+
+#include "DroneUtil.h"
+#include "SigKernels.h"
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace cdra;
+
+// The floats of [-1, 0] are those with bits from -0 to -1, in increasing magnitude
+static const uint32_t FIRST = 0x80000000u, LAST = 0xbf800000u;
+static const uint32_t CHUNK = 1 << 16;
+
+static float from_bits(uint32_t bits) {
+  float x;
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+int main(int argc, char **argv)
+{
+  droneutil::SIMD_KERNELS = true;
+  bool simd = kernels::avx2Available();
+  int threads = max(std::thread::hardware_concurrency(), 1u);
+
+  // Per worker: the largest error and where, and the first disagreement
+  struct Result {
+    double error = 0;
+    float worst = 0;
+    bool disagree = false;
+    float where = 0;
+  };
+  vector<Result> results(threads);
+  uint32_t chunks = (LAST - FIRST) / CHUNK + 1;
+  ThreadPool pool(threads);
+  pool.parallelFor(chunks, [&](int chunk, int worker) {
+      Result& result = results[worker];
+      uint32_t first = FIRST + (uint32_t)chunk * CHUNK;
+      uint32_t n = min<uint64_t>(CHUNK, (uint64_t)LAST + 1 - first);
+      vector<float> xs(n), curve(n), normalized(n);
+      for(uint32_t i = 0; i < n; i++) {
+	xs[i] = from_bits(first + i);
+	double x = xs[i];
+	double error = fabs(kernels::penaltyCurve(xs[i]) - (-((pow(32.0, -x) - 1) / 31) + x));
+	if(error > result.error) {
+	  result.error = error;
+	  result.worst = xs[i];
+	}
+      }
+      if(!simd) {
+	return;
+      }
+      curve = xs;
+      kernels::penaltyCurve(curve.data(), n);
+      normalized = xs;
+      kernels::normalize(normalized.data(), n, -1, 1, true);
+      for(uint32_t i = 0; i < n && !result.disagree; i++) {
+	float scalar_curve = kernels::penaltyCurve(xs[i]);
+	float scalar_normalized = kernels::normalize(xs[i], -1, 1, true);
+	if(memcmp(&curve[i], &scalar_curve, sizeof(float)) ||
+	   memcmp(&normalized[i], &scalar_normalized, sizeof(float))) {
+	  result.disagree = true;
+	  result.where = xs[i];
+	}
+      }
+    });
+
+  Result total;
+  for(auto& result : results) {
+    if(result.error > total.error) {
+      total.error = result.error;
+      total.worst = result.worst;
+    }
+    if(result.disagree && !total.disagree) {
+      total.disagree = true;
+      total.where = result.where;
+    }
+  }
+
+  bool ok = true;
+  cout.precision(9);
+  cout << "Penalty curve max error " << total.error << " at " << total.worst
+       << " (bound " << kernels::PENALTY_CURVE_MAX_ERROR << ")" << endl;
+  if(total.error > kernels::PENALTY_CURVE_MAX_ERROR) {
+    cout << "FAILED: the error exceeds PENALTY_CURVE_MAX_ERROR" << endl;
+    ok = false;
+  }
+  if(!simd) {
+    cout << "No AVX2 on this CPU: scalar and AVX2 kernels not compared" << endl;
+  } else if(total.disagree) {
+    cout << "FAILED: the AVX2 and scalar kernels differ at " << total.where << endl;
+    ok = false;
+  } else {
+    cout << "AVX2 and scalar kernels agree" << endl;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
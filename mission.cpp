@@ -99,7 +99,7 @@ namespace cdra {
     store->writeSignal({"enemy_pos_east_m", "enemy_pos_north_m"}, logdir+"/plot_enemy_drone.dat");
     store->writeSignal({
 	"pos_east_m", "pos_north_m", "pos_down_m",
-	"vel_east_m_s", "vel_north_m_s", "vel_down_m_s"
+	"vel_east_m_s", "vel_north_m_s", "vel_down_m_s",
 	"enemy_pos_east_m", "enemy_pos_north_m", "enemy_pos_down_m",
 	"enemy_vel_east_m_s", "enemy_vel_north_m_s", "enemy_vel_down_m_s"},
       logdir + "/statestore.log");
@@ -45,6 +45,7 @@
 #include "PriorityCoordinator.h"
 #include "ConjunctionCoordinator.h"
 #include "RobustnessCoordinator.h"
+#include "MpcCoordinator.h"
 
 #include "Enforcer.h"
 #include "ElasticEnforcer.h"
@@ -54,6 +55,7 @@
 #include "FlightEnforcer.h"
 #include "MissileEnforcer.h"
 #include "ReconEnforcer.h"
+#include "ObstacleEnforcer.h"
 
 #include "flyeightmission.h"
 #include "reconmission.h"
@@ -141,6 +143,8 @@ std::shared_ptr<cdra::Enforcer> make_enforcer(string enforcer_name, std::shared_
 	        enforcer = std::make_shared<cdra::ReconEnforcer>(offboard, telemetry, store);  
 	} else if (enforcer_name == "MissileEnforcer") {
 	        enforcer = std::make_shared<cdra::MissileEnforcer>(offboard, telemetry, store);  
+	} else if (enforcer_name == "ObstacleEnforcer") {
+	        enforcer = std::make_shared<cdra::ObstacleEnforcer>(offboard, telemetry, store);
 	} else {
 	  cerr << "Invalid enforcer name given." << endl;
 	  exit(1);
@@ -198,6 +202,8 @@ std::shared_ptr<cdra::Coordinator> make_coordinator(string coordinator_name, std
   } else if(coordinator_name == "SynthRobustnessCoordinator") { // NOTE: overrides SYNTHESIZE_ACTIONS config param
     droneutil::SYNTHESIZE_ACTIONS = 1;
     coordinator = make_shared<RobustnessCoordinator>(offboard, telemetry, store);
+  } else if(coordinator_name == "MpcCoordinator") {
+    coordinator = make_shared<MpcCoordinator>(offboard, telemetry, store);
   } else if(coordinator_name == "ConjunctionCoordinator") {
     coordinator = make_shared<ConjunctionCoordinator>(offboard, telemetry, store);
   } else {
@@ -319,6 +325,9 @@ int main(int argc, char **argv)
     //{"ReconEnforcer",  droneutil::RECON_WEIGHT},
     {"MissileEnforcer",  droneutil::MISSILE_WEIGHT}
   };
+  if(!droneutil::OBSTACLE_FILE.empty()) {
+    enforcer_data["ObstacleEnforcer"] = droneutil::OBSTACLE_WEIGHT;
+  }
 
   coordinator = make_coordinator(coordinator_name, offboard,
 				 telemetry, store, enforcer_data);
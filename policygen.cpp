@@ -0,0 +1,292 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+/*
+ * Compiles a policy table (see PolicyTable.h) offline: sweeps a grid of
+ * situations (ego position and velocity, enemy offset), synthesizes the
+ * action for the properties violated at each one with get_optimal_action,
+ * and writes the actions to a file that missionapp maps with
+ * POLICY_TABLE_FILE.
+ *
+ * The enforcers and their weights are those missionapp uses with the same
+ * drone.cfg. Each situation is held as a single state, so the properties
+ * must only depend on the latest state; the enemy is taken to be pursuing
+ * the ego drone at ENEMY_DRONE_SPEED. The search covers every direction
+ * (the proposed actions are not known offline), with SYNTHESIS_DEADLINE
+ * and the trust region off.
+ */
+
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <thread>
+
+#include "DroneUtil.h"
+#include "PolicyTable.h"
+#include "RobustnessCoordinator.h"
+#include "StateStore.h"
+#include "BoundaryEnforcer.h"
+#include "RunawayEnforcer.h"
+#include "FlightEnforcer.h"
+#include "MissileEnforcer.h"
+#include "ObstacleEnforcer.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+using namespace cdra;
+
+enum ARGS {
+  INDIR,
+  OUT,
+  POSITION_STEP,
+  VELOCITY_STEP,
+  OFFSET_STEP,
+  OFFSET_RANGE,
+  THREADS
+};
+
+static struct option long_options[] = {
+  { "indir",         required_argument, 0, INDIR         },
+  { "out",           required_argument, 0, OUT           },
+  { "position-step", required_argument, 0, POSITION_STEP },
+  { "velocity-step", required_argument, 0, VELOCITY_STEP },
+  { "offset-step",   required_argument, 0, OFFSET_STEP   },
+  { "offset-range",  required_argument, 0, OFFSET_RANGE  },
+  { "threads",       required_argument, 0, THREADS       },
+  {0, 0, 0, 0 }
+};
+
+void usage(const char* appname) {
+  cout << "usage: " << appname << " [options]" << endl;
+  cout << "valid options are:" << endl;
+  int opt = 0;
+  while (long_options[opt].name != 0) {
+    cout << "\t--" << long_options[opt].name << "=value" << endl;
+    opt++;
+  }
+  exit(EXIT_FAILURE);
+}
+
+std::shared_ptr<StlEnforcer> make_enforcer(string enforcer_name, std::shared_ptr<StateStore> store) {
+  if (enforcer_name == "BoundaryEnforcer") {
+    return std::make_shared<BoundaryEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "RunawayEnforcer") {
+    return std::make_shared<RunawayEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "FlightEnforcer") {
+    return std::make_shared<FlightEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "MissileEnforcer") {
+    return std::make_shared<MissileEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "ObstacleEnforcer") {
+    return std::make_shared<ObstacleEnforcer>(nullptr, nullptr, store);
+  }
+  cerr << "Invalid enforcer name given." << endl;
+  exit(1);
+}
+
+/* Points of an axis from "low" to "high" spaced by "step" (a single one, at the middle, if step is 0) */
+void make_axis(float low, float high, float step, unsigned int& count, float& origin, float& axis_step) {
+  if (step <= 0 || high <= low) {
+    count = 1;
+    origin = (low + high) / 2;
+    axis_step = 0;
+  } else {
+    count = (unsigned int)floor((high - low) / step + 1e-3) + 1;
+    origin = low;
+    axis_step = step;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  string in_dir = ".";
+  string out_file = "policy.bin";
+  float position_step = 2.5, velocity_step = 2, offset_step = 2, offset_range = -1;
+  int threads = 0;
+
+  while (1) {
+    int option_index = 0;
+    auto c = getopt_long(argc, argv, "", long_options, &option_index);
+    if (c == -1) {
+      break;
+    }
+    switch (c) {
+    case INDIR:
+      in_dir = optarg;
+      break;
+    case OUT:
+      out_file = optarg;
+      break;
+    case POSITION_STEP:
+      position_step = atof(optarg);
+      break;
+    case VELOCITY_STEP:
+      velocity_step = atof(optarg);
+      break;
+    case OFFSET_STEP:
+      offset_step = atof(optarg);
+      break;
+    case OFFSET_RANGE:
+      offset_range = atof(optarg);
+      break;
+    case THREADS:
+      threads = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc) {
+    usage(argv[0]);
+  }
+
+  droneutil::parseConfig(in_dir+"/drone.cfg");
+  droneutil::SYNTHESIZE_ACTIONS = 1;
+  droneutil::SYNTHESIS_DEADLINE = 0;
+  if (offset_range < 0) {
+    offset_range = droneutil::ENEMY_CHASE_DISTANCE + 1;
+  }
+  if (threads <= 0) {
+    threads = max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  // Same enforcers, in the same order, as missionapp
+  auto store = std::make_shared<StateStore>(nullptr, nullptr);
+  map<string, float> enforcer_data {
+    {"BoundaryEnforcer", droneutil::BOUNDARY_WEIGHT},
+    {"RunawayEnforcer",  droneutil::RUNAWAY_WEIGHT},
+    {"FlightEnforcer",   droneutil::FLIGHT_WEIGHT},
+    {"MissileEnforcer",  droneutil::MISSILE_WEIGHT}
+  };
+  if(!droneutil::OBSTACLE_FILE.empty()) {
+    enforcer_data["ObstacleEnforcer"] = droneutil::OBSTACLE_WEIGHT;
+  }
+  vector<std::shared_ptr<StlEnforcer>> enforcers;
+  vector<StlExpr*> properties;
+  vector<float> weights;
+  for(auto kv : enforcer_data) {
+    enforcers.push_back(make_enforcer(kv.first, store));
+    properties.push_back(enforcers.back()->getProp());
+    weights.push_back(kv.second);
+  }
+
+  // Grid: ego position within the boundary (above ground), ego velocity up to the max speed, enemy offset
+  unsigned int counts[PolicyTable::AXES];
+  float origin[PolicyTable::AXES], step[PolicyTable::AXES];
+  float speed = droneutil::MAX_DRONE_SPEED;
+  make_axis(droneutil::BOUNDARY_X_MIN, droneutil::BOUNDARY_X_MAX, position_step, counts[0], origin[0], step[0]);
+  make_axis(droneutil::BOUNDARY_Y_MIN, droneutil::BOUNDARY_Y_MAX, position_step, counts[1], origin[1], step[1]);
+  make_axis(-droneutil::BOUNDARY_Z_MAX, -max(droneutil::BOUNDARY_Z_MIN, 0.0f), position_step, counts[2], origin[2], step[2]);
+  make_axis(-speed, speed, velocity_step, counts[3], origin[3], step[3]);
+  make_axis(-speed, speed, velocity_step, counts[4], origin[4], step[4]);
+  make_axis(-speed, speed, droneutil::EGO_Z_VELOCITY ? velocity_step : 0, counts[5], origin[5], step[5]);
+  for(int a = 6; a < 9; a++) {
+    make_axis(-offset_range, offset_range, offset_step, counts[a], origin[a], step[a]);
+  }
+  size_t points = 1;
+  for(int a = 0; a < PolicyTable::AXES; a++) {
+    points *= counts[a];
+  }
+  cerr << "Sweeping " << points << " situations with " << threads << " threads" << endl;
+
+  // Seeds spanning every direction, so the whole sphere (or box) is searched
+  vector<Offboard::VelocityNEDYaw> seeds {
+    { speed, 0, 0, 0 }, { -speed, 0, 0, 0 }, { 0, speed, 0, 0 }, { 0, -speed, 0, 0 } };
+  if(droneutil::EGO_Z_VELOCITY) {
+    seeds.push_back({ 0, 0, speed, 0 });
+    seeds.push_back({ 0, 0, -speed, 0 });
+  }
+
+  // The synthesis log would be one screenful per situation
+  cout.setstate(ios::failbit);
+
+  // Rows of the last axis are dealt to the workers, each with its own signal
+  const int ROW = counts[PolicyTable::AXES - 1];
+  vector<PolicyTable::Cell> cells(points);
+  vector<std::shared_ptr<StateStore>> stores;
+  for(int w = 0; w < threads; w++) {
+    stores.push_back(std::make_shared<StateStore>(nullptr, nullptr));
+  }
+  std::unique_ptr<DroneModel> model(DroneModel::create(droneutil::DRONE_MODEL));
+  ThreadPool pool(threads);
+  auto start_time = std::chrono::steady_clock::now();
+  pool.parallelFor(points / ROW, [&](int row, int worker) {
+      Signal* signal = stores[worker]->getSignal();
+      // Seeded by row, so the table does not depend on the number of threads
+      auto generator = CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED + row);
+      for(int i = 0; i < ROW; i++) {
+	size_t index = (size_t)row * ROW + i;
+	float state[PolicyTable::AXES];
+	size_t rest = index;
+	for(int a = PolicyTable::AXES - 1; a >= 0; a--) {
+	  state[a] = origin[a] + (rest % counts[a]) * step[a];
+	  rest /= counts[a];
+	}
+	float enemy[3] = { state[0] + state[6], state[1] + state[7], state[2] + state[8] };
+	float pursuit[3] = { -state[6], -state[7], droneutil::FOLLOWER_Z_VELOCITY ? -state[8] : 0 };
+	float norm = sqrt(pursuit[0]*pursuit[0] + pursuit[1]*pursuit[1] + pursuit[2]*pursuit[2]);
+	float enemy_speed = norm > 0 ? droneutil::ENEMY_DRONE_SPEED / norm : 0;
+	signal->append({ state[1], state[0], state[2], state[4], state[3], state[5],
+			 enemy[1], enemy[0], enemy[2],
+			 pursuit[1] * enemy_speed, pursuit[0] * enemy_speed, pursuit[2] * enemy_speed });
+	int t = signal->length() - 1;
+
+	vector<StlExpr*> active;
+	vector<float> active_weights;
+	PolicyTable::Cell& cell = cells[index];
+	cell = { 0, 0, 0, 0 };
+	for(unsigned int p = 0; p < properties.size(); p++) {
+	  if(!properties[p]->sat(signal, t)) {
+	    active.push_back(properties[p]);
+	    active_weights.push_back(weights[p]);
+	    cell.mask |= 1u << p;
+	  }
+	}
+	if(active.size() >= 2) {
+	  float robustness;
+	  auto action = get_optimal_action(active, active_weights, seeds, stores[worker], t, *model, *generator,
+					   std::chrono::steady_clock::time_point::max(), nullptr, nullptr, robustness);
+	  cell = { action.north_m_s, action.east_m_s, action.down_m_s, cell.mask };
+	}
+	signal->pop();
+      }
+    });
+
+  cout.clear();
+  float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start_time).count();
+  size_t conflicts = count_if(cells.begin(), cells.end(),
+			      [](const PolicyTable::Cell& cell) { return __builtin_popcount(cell.mask) >= 2; });
+  cerr << "Synthesized " << conflicts << " conflicts in " << seconds << " s" << endl;
+
+  if(!PolicyTable::create(out_file, cells, counts, origin, step, weights)) {
+    cerr << "Cannot write policy table: " << out_file << endl;
+    return EXIT_FAILURE;
+  }
+  cerr << "Wrote " << out_file << endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+/*
+ * Checks the evaluation counters of ActionScorer (evaluations and
+ * prunedEvaluations, recorded as the stats property_evaluations and
+ * pruned_evaluations) on conflicts at random situations: scoring the
+ * candidates in chunks against the best score so far, as sampled
+ * synthesis does, the evaluations done and skipped must add up to the
+ * candidates times the properties, with some done, both per action
+ * (BATCH_SCORING=0, where SHORT_CIRCUIT_SCORING skips some) and in
+ * batches.
+ *
+ * The enforcers and their weights are those missionapp uses with the
+ * drone.cfg of the current directory. Exits with failure otherwise;
+ * "make check" runs it.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <random>
+
+#include "DroneUtil.h"
+#include "ActionScorer.h"
+#include "CandidateGenerator.h"
+#include "RobustnessCoordinator.h"
+#include "StateStore.h"
+#include "BoundaryEnforcer.h"
+#include "RunawayEnforcer.h"
+#include "FlightEnforcer.h"
+#include "MissileEnforcer.h"
+#include "ObstacleEnforcer.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+using namespace cdra;
+
+// Conflicts checked, and candidates scored at each, in chunks of CHUNK
+static const int CONFLICTS = 50, CANDIDATES = 512, CHUNK = 32;
+
+std::shared_ptr<StlEnforcer> make_enforcer(string enforcer_name, std::shared_ptr<StateStore> store) {
+  if (enforcer_name == "BoundaryEnforcer") {
+    return std::make_shared<BoundaryEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "RunawayEnforcer") {
+    return std::make_shared<RunawayEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "FlightEnforcer") {
+    return std::make_shared<FlightEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "MissileEnforcer") {
+    return std::make_shared<MissileEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "ObstacleEnforcer") {
+    return std::make_shared<ObstacleEnforcer>(nullptr, nullptr, store);
+  }
+  cerr << "Invalid enforcer name given." << endl;
+  exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  droneutil::parseConfig("drone.cfg");
+  droneutil::SHORT_CIRCUIT_SCORING = true;
+
+  // Same enforcers, in the same order, as missionapp
+  auto store = std::make_shared<StateStore>(nullptr, nullptr);
+  map<string, float> enforcer_data {
+    {"BoundaryEnforcer", droneutil::BOUNDARY_WEIGHT},
+    {"RunawayEnforcer",  droneutil::RUNAWAY_WEIGHT},
+    {"FlightEnforcer",   droneutil::FLIGHT_WEIGHT},
+    {"MissileEnforcer",  droneutil::MISSILE_WEIGHT}
+  };
+  if(!droneutil::OBSTACLE_FILE.empty()) {
+    enforcer_data["ObstacleEnforcer"] = droneutil::OBSTACLE_WEIGHT;
+  }
+  vector<std::shared_ptr<StlEnforcer>> enforcers;
+  vector<StlExpr*> properties;
+  vector<float> weights;
+  for(auto kv : enforcer_data) {
+    enforcers.push_back(make_enforcer(kv.first, store));
+    properties.push_back(enforcers.back()->getProp());
+    weights.push_back(kv.second);
+  }
+
+  float speed = droneutil::MAX_DRONE_SPEED;
+  vector<Offboard::VelocityNEDYaw> seeds {
+    { speed, 0, 0, 0 }, { -speed, 0, 0, 0 }, { 0, speed, 0, 0 }, { 0, -speed, 0, 0 } };
+  if(droneutil::EGO_Z_VELOCITY) {
+    seeds.push_back({ 0, 0, speed, 0 });
+    seeds.push_back({ 0, 0, -speed, 0 });
+  }
+
+  // The synthesis log would be one screenful per conflict
+  cout.setstate(ios::failbit);
+
+  // Situations: the ego drone anywhere within the boundary, the enemy pursuing it from close by
+  std::mt19937 gen(droneutil::SEARCH_SEED);
+  std::uniform_real_distribution<float> x(droneutil::BOUNDARY_X_MIN, droneutil::BOUNDARY_X_MAX);
+  std::uniform_real_distribution<float> y(droneutil::BOUNDARY_Y_MIN, droneutil::BOUNDARY_Y_MAX);
+  std::uniform_real_distribution<float> z(-droneutil::BOUNDARY_Z_MAX, -max(droneutil::BOUNDARY_Z_MIN, 0.0f));
+  std::uniform_real_distribution<float> v(-speed, speed);
+  std::uniform_real_distribution<float> offset(-droneutil::ENEMY_CHASE_DISTANCE, droneutil::ENEMY_CHASE_DISTANCE);
+  std::unique_ptr<DroneModel> model(DroneModel::create(droneutil::DRONE_MODEL));
+  Signal* signal = store->getSignal();
+
+  const int PATHS = 2;
+  const char* path_names[PATHS] = { "per action", "batched" };
+  unsigned long evaluated[PATHS] = { 0, 0 }, pruned[PATHS] = { 0, 0 }, expected[PATHS] = { 0, 0 };
+  int conflicts = 0, failures = 0;
+  for(int tries = 0; conflicts < CONFLICTS && tries < 100 * CONFLICTS; tries++) {
+    float north = x(gen), east = y(gen), down = z(gen);
+    float delta[3] = { offset(gen), offset(gen), droneutil::FOLLOWER_Z_VELOCITY ? offset(gen) : 0 };
+    float norm = sqrt(delta[0]*delta[0] + delta[1]*delta[1] + delta[2]*delta[2]);
+    float enemy_speed = norm > 0 ? droneutil::ENEMY_DRONE_SPEED / norm : 0;
+    signal->append({ east, north, down, v(gen), v(gen), droneutil::EGO_Z_VELOCITY ? v(gen) : 0,
+		     east - delta[1], north - delta[0], down - delta[2],
+		     delta[1] * enemy_speed, delta[0] * enemy_speed, delta[2] * enemy_speed });
+    int t = signal->length() - 1;
+
+    vector<StlExpr*> active;
+    vector<float> active_weights;
+    for(unsigned int p = 0; p < properties.size(); p++) {
+      if(!properties[p]->sat(signal, t)) {
+	active.push_back(properties[p]);
+	active_weights.push_back(weights[p]);
+      }
+    }
+    if(active.size() >= 2) {
+      auto generator = CandidateGenerator::create(CandidateGenerator::HALTON, droneutil::SEARCH_SEED + conflicts);
+      vector<Offboard::VelocityNEDYaw> candidates = seeds;
+      while(candidates.size() < (size_t)CANDIDATES) {
+	auto synthesized = get_reasonable_actions(seeds, *generator);
+	candidates.insert(candidates.end(), synthesized.begin(), synthesized.end());
+      }
+      candidates.resize(CANDIDATES);
+
+      for(int path = 0; path < PATHS; path++) {
+	droneutil::BATCH_SCORING = path == 1;
+	// As score_until_deadline: the first chunk has no incumbent to beat
+	ActionScorer scorer(active, active_weights, signal, t, *model);
+	float best = -INFINITY;
+	for(int first = 0; first < CANDIDATES; first += CHUNK) {
+	  vector<Offboard::VelocityNEDYaw> chunk(candidates.begin() + first, candidates.begin() + first + CHUNK);
+	  vector<float> scores;
+	  scorer.score(chunk, scores, best);
+	  best = max(best, *max_element(scores.begin(), scores.end()));
+	}
+	unsigned long total = (unsigned long)CANDIDATES * active.size();
+	if(scorer.evaluations() == 0 || scorer.evaluations() + scorer.prunedEvaluations() != total) {
+	  cerr << "Tick " << t << ", " << path_names[path] << ": " << scorer.evaluations() << " evaluations and "
+	       << scorer.prunedEvaluations() << " pruned for " << total << endl;
+	  failures++;
+	}
+	evaluated[path] += scorer.evaluations();
+	pruned[path] += scorer.prunedEvaluations();
+	expected[path] += total;
+      }
+      conflicts++;
+    }
+    signal->pop();
+  }
+
+  cout.clear();
+  cout << "Conflicts: " << conflicts << ", " << CANDIDATES << " candidates each" << endl;
+  for(int path = 0; path < PATHS; path++) {
+    cout << "Scored " << path_names[path] << ": " << evaluated[path] << " evaluations, " << pruned[path]
+	 << " pruned, of " << expected[path] << endl;
+  }
+  if(conflicts == 0) {
+    cout << "FAILED: no conflict found" << endl;
+    return EXIT_FAILURE;
+  }
+  if(failures) {
+    cout << "FAILED: " << failures << " counts do not add up to the candidates times the properties" << endl;
+    return EXIT_FAILURE;
+  }
+  if(pruned[0] == 0) {
+    cout << "FAILED: no evaluation pruned per action" << endl;
+    return EXIT_FAILURE;
+  }
+  cout << "Evaluation counters add up" << endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,379 @@
+/*
+ * Synthesis-based resolution of features/enforcers interactions in CPS
+ * Copyright 2020 Carnegie Mellon University.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ * AS TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR
+ * PURPOSE OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF
+ * THE MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY
+ * KIND WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT
+ * INFRINGEMENT.
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public
+ * release and unlimited distribution.  Please see Copyright notice for
+ * non-US Government use and distribution.
+ * This Software includes and/or makes use of the following Third-Party Software
+ * subject to its own license:
+ * 1. JsonCpp
+ * (https://github.com/open-source-parsers/jsoncpp/blob/master/LICENSE)
+ * Copyright 2010 Baptiste Lepilleur and The JsonCpp Authors.
+ * DM20-0762
+ */
+
+/*
+ * Benchmarks the candidate generators (see CandidateGenerator.h) on the
+ * conflicts of a recorded run: replays the states of a statestore.log
+ * tick by tick, and at each tick where several properties are violated
+ * scores the candidates each generator synthesizes, in generation order,
+ * reporting how many it takes to reach the robustness random search
+ * reaches with all of them.
+ *
+ * With --threads=N, it also times ActionScorer::score on the same
+ * conflicts with thread pools of 1, 2, 4, ... up to N workers, per action
+ * and in batches (BATCH_SCORING), and checks that the scores and the
+ * action get_optimal_action chooses are bitwise the same as those of the
+ * serial path; it exits with failure otherwise.
+ *
+ * The enforcers and their weights are those missionapp uses with the same
+ * drone.cfg. The proposed actions are not logged, so, as in policygen, the
+ * search is seeded with actions spanning every direction.
+ */
+
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <sstream>
+
+#include "DroneUtil.h"
+#include "ActionScorer.h"
+#include "CandidateGenerator.h"
+#include "RobustnessCoordinator.h"
+#include "StateBatch.h"
+#include "StateStore.h"
+#include "ThreadPool.h"
+#include "BoundaryEnforcer.h"
+#include "RunawayEnforcer.h"
+#include "FlightEnforcer.h"
+#include "MissileEnforcer.h"
+#include "ObstacleEnforcer.h"
+
+using namespace dronecode_sdk;
+using namespace std;
+using namespace cdra;
+
+enum ARGS {
+  INDIR,
+  LOG,
+  CANDIDATES,
+  TOLERANCE,
+  THREADS
+};
+
+static struct option long_options[] = {
+  { "indir",      required_argument, 0, INDIR      },
+  { "log",        required_argument, 0, LOG        },
+  { "candidates", required_argument, 0, CANDIDATES },
+  { "tolerance",  required_argument, 0, TOLERANCE  },
+  { "threads",    required_argument, 0, THREADS    },
+  {0, 0, 0, 0 }
+};
+
+void usage(const char* appname) {
+  cout << "usage: " << appname << " [options]" << endl;
+  cout << "valid options are:" << endl;
+  int opt = 0;
+  while (long_options[opt].name != 0) {
+    cout << "\t--" << long_options[opt].name << "=value" << endl;
+    opt++;
+  }
+  exit(EXIT_FAILURE);
+}
+
+std::shared_ptr<StlEnforcer> make_enforcer(string enforcer_name, std::shared_ptr<StateStore> store) {
+  if (enforcer_name == "BoundaryEnforcer") {
+    return std::make_shared<BoundaryEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "RunawayEnforcer") {
+    return std::make_shared<RunawayEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "FlightEnforcer") {
+    return std::make_shared<FlightEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "MissileEnforcer") {
+    return std::make_shared<MissileEnforcer>(nullptr, nullptr, store);
+  } else if (enforcer_name == "ObstacleEnforcer") {
+    return std::make_shared<ObstacleEnforcer>(nullptr, nullptr, store);
+  }
+  cerr << "Invalid enforcer name given." << endl;
+  exit(1);
+}
+
+/* Reads the states of a statestore.log (see Mission::log): a "curve" line, then
+ * the 12 state values of each tick and the tick, comma separated */
+bool read_states(string fname, vector<vector<float>>& states) {
+  ifstream in(fname);
+  if (!in) {
+    return false;
+  }
+  string line;
+  while (getline(in, line)) {
+    vector<float> row;
+    stringstream fields(line);
+    string field;
+    while (getline(fields, field, ',')) {
+      row.push_back(atof(field.c_str()));
+    }
+    if (row.size() == StateBatch::NUM_CHANNELS + 1) {
+      row.pop_back(); // the tick
+      states.push_back(row);
+    }
+  }
+  return true;
+}
+
+/* The first "count" candidates "generator" synthesizes for the "seeds", after the seeds */
+vector<Offboard::VelocityNEDYaw> make_candidates(const vector<Offboard::VelocityNEDYaw>& seeds,
+						 CandidateGenerator& generator, unsigned int count) {
+  vector<Offboard::VelocityNEDYaw> candidates = seeds;
+  while (candidates.size() < count) {
+    // Each call continues the generator's sequence
+    auto synthesized = get_reasonable_actions(seeds, generator);
+    if (synthesized.empty()) {
+      break;
+    }
+    candidates.insert(candidates.end(), synthesized.begin(), synthesized.end());
+  }
+  candidates.resize(min<size_t>(candidates.size(), count));
+  return candidates;
+}
+
+/* Whether "n" floats of "a" and "b" have the same bits */
+bool same_bits(const float* a, const float* b, size_t n) {
+  return memcmp(a, b, n * sizeof(float)) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  string in_dir = ".";
+  string log_file = "statestore.log";
+  unsigned int num_candidates = 1024;
+  float tolerance = 1e-2;
+  int max_threads = 0;
+
+  while (1) {
+    int option_index = 0;
+    auto c = getopt_long(argc, argv, "", long_options, &option_index);
+    if (c == -1) {
+      break;
+    }
+    switch (c) {
+    case INDIR:
+      in_dir = optarg;
+      break;
+    case LOG:
+      log_file = optarg;
+      break;
+    case CANDIDATES:
+      num_candidates = atoi(optarg);
+      break;
+    case TOLERANCE:
+      tolerance = atof(optarg);
+      break;
+    case THREADS:
+      max_threads = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc || num_candidates == 0) {
+    usage(argv[0]);
+  }
+
+  droneutil::parseConfig(in_dir+"/drone.cfg");
+  droneutil::SYNTHESIZE_ACTIONS = 1;
+  vector<vector<float>> states;
+  if (!read_states(log_file, states)) {
+    cerr << "Cannot read states: " << log_file << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Same enforcers, in the same order, as missionapp
+  auto store = std::make_shared<StateStore>(nullptr, nullptr);
+  map<string, float> enforcer_data {
+    {"BoundaryEnforcer", droneutil::BOUNDARY_WEIGHT},
+    {"RunawayEnforcer",  droneutil::RUNAWAY_WEIGHT},
+    {"FlightEnforcer",   droneutil::FLIGHT_WEIGHT},
+    {"MissileEnforcer",  droneutil::MISSILE_WEIGHT}
+  };
+  if(!droneutil::OBSTACLE_FILE.empty()) {
+    enforcer_data["ObstacleEnforcer"] = droneutil::OBSTACLE_WEIGHT;
+  }
+  vector<std::shared_ptr<StlEnforcer>> enforcers;
+  vector<StlExpr*> properties;
+  vector<float> weights;
+  for(auto kv : enforcer_data) {
+    enforcers.push_back(make_enforcer(kv.first, store));
+    properties.push_back(enforcers.back()->getProp());
+    weights.push_back(kv.second);
+  }
+
+  // Seeds spanning every direction, so the whole sphere (or box) is searched
+  float speed = droneutil::MAX_DRONE_SPEED;
+  vector<Offboard::VelocityNEDYaw> seeds {
+    { speed, 0, 0, 0 }, { -speed, 0, 0, 0 }, { 0, speed, 0, 0 }, { 0, -speed, 0, 0 } };
+  if(droneutil::EGO_Z_VELOCITY) {
+    seeds.push_back({ 0, 0, speed, 0 });
+    seeds.push_back({ 0, 0, -speed, 0 });
+  }
+
+  // The synthesis log would be one screenful per conflict
+  cout.setstate(ios::failbit);
+
+  // Per generator: candidates to reach random search's robustness, conflicts where
+  // it did, and its robustness with all of them
+  const int KINDS = 2;
+  const char* kind_names[KINDS] = { "RANDOM", "HALTON" };
+  vector<unsigned int> needed[KINDS];
+  double best_sum[KINDS] = { 0, 0 };
+  std::unique_ptr<DroneModel> model(DroneModel::create(droneutil::DRONE_MODEL));
+  Signal* signal = store->getSignal();
+  unsigned int conflicts = 0;
+
+  // Thread sweep: a pool per thread count, and the scoring time of each path with each
+  const int PATHS = 2;
+  const char* path_names[PATHS] = { "per action", "batched" };
+  vector<int> thread_counts;
+  for(int threads = 1; max_threads > 0 && threads < 2 * max_threads; threads *= 2) {
+    thread_counts.push_back(min(threads, max_threads));
+  }
+  vector<std::unique_ptr<ThreadPool>> pools;
+  for(int threads : thread_counts) {
+    pools.emplace_back(new ThreadPool(threads));
+  }
+  vector<double> scoring_ms[PATHS];
+  scoring_ms[0].assign(pools.size(), 0);
+  scoring_ms[1].assign(pools.size(), 0);
+  unsigned int mismatches = 0;
+  const bool batch_scoring = droneutil::BATCH_SCORING;
+  for(auto& state : states) {
+    signal->append(state);
+    int t = signal->length() - 1;
+
+    vector<StlExpr*> active;
+    vector<float> active_weights;
+    for(unsigned int p = 0; p < properties.size(); p++) {
+      if(!properties[p]->sat(signal, t)) {
+	active.push_back(properties[p]);
+	active_weights.push_back(weights[p]);
+      }
+    }
+    if(active.size() < 2) {
+      continue;
+    }
+
+    // Best robustness of each prefix of each generator's candidates
+    ActionScorer scorer(active, active_weights, signal, t, *model);
+    vector<float> running[KINDS];
+    for(int kind = 0; kind < KINDS; kind++) {
+      auto generator = CandidateGenerator::create(kind, droneutil::SEARCH_SEED + conflicts);
+      auto candidates = make_candidates(seeds, *generator, num_candidates);
+      vector<float> scores;
+      scorer.score(candidates, scores);
+      float best = -INFINITY;
+      for(float score : scores) {
+	best = max(best, score);
+	running[kind].push_back(best);
+      }
+      best_sum[kind] += best;
+    }
+    float target = running[CandidateGenerator::RANDOM].back() - tolerance;
+    for(int kind = 0; kind < KINDS; kind++) {
+      auto reached = lower_bound(running[kind].begin(), running[kind].end(), target);
+      if(reached != running[kind].end()) {
+	needed[kind].push_back(reached - running[kind].begin() + 1);
+      }
+    }
+
+    // The same scores and chosen action with every pool as without one
+    auto generator = CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED + conflicts);
+    auto candidates = make_candidates(seeds, *generator, num_candidates);
+    for(int path = 0; !pools.empty() && path < PATHS; path++) {
+      droneutil::BATCH_SCORING = path == 1;
+      vector<float> serial_scores;
+      ActionScorer(active, active_weights, signal, t, *model).score(candidates, serial_scores);
+      float serial_robustness;
+      generator = CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED + conflicts);
+      auto serial_action = get_optimal_action(active, active_weights, seeds, store, t, *model, *generator,
+					      std::chrono::steady_clock::time_point::max(), nullptr, nullptr,
+					      serial_robustness, true);
+      for(unsigned int i = 0; i < pools.size(); i++) {
+	ActionScorer pooled(active, active_weights, signal, t, *model, pools[i].get());
+	vector<float> scores;
+	auto start_time = std::chrono::steady_clock::now();
+	pooled.score(candidates, scores);
+	scoring_ms[path][i] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	float robustness;
+	generator = CandidateGenerator::create(droneutil::CANDIDATE_GENERATOR, droneutil::SEARCH_SEED + conflicts);
+	auto action = get_optimal_action(active, active_weights, seeds, store, t, *model, *generator,
+					 std::chrono::steady_clock::time_point::max(), pools[i].get(), nullptr,
+					 robustness, true);
+	float chosen[4] = { action.north_m_s, action.east_m_s, action.down_m_s, robustness };
+	float serial_chosen[4] = { serial_action.north_m_s, serial_action.east_m_s, serial_action.down_m_s,
+				   serial_robustness };
+	if(scores.size() != serial_scores.size() || !same_bits(scores.data(), serial_scores.data(), scores.size()) ||
+	   !same_bits(chosen, serial_chosen, 4)) {
+	  cerr << "Tick " << t << ", " << path_names[path] << ", " << thread_counts[i]
+	       << " threads: not the same as the serial path" << endl;
+	  mismatches++;
+	}
+      }
+    }
+    droneutil::BATCH_SCORING = batch_scoring;
+    conflicts++;
+  }
+
+  cout.clear();
+  cout << "Conflicts: " << conflicts << " of " << states.size() << " ticks, "
+       << num_candidates << " candidates each" << endl;
+  if(conflicts == 0) {
+    return EXIT_SUCCESS;
+  }
+  for(int kind = 0; kind < KINDS; kind++) {
+    auto& counts = needed[kind];
+    sort(counts.begin(), counts.end());
+    double mean = 0;
+    for(auto count : counts) {
+      mean += count;
+    }
+    mean = counts.empty() ? 0 : mean / counts.size();
+    cout << kind_names[kind] << ": reached random search's robustness (within " << tolerance << ") in "
+	 << counts.size() << " of " << conflicts << " conflicts, candidates needed mean " << mean
+	 << " median " << (counts.empty() ? 0 : counts[counts.size() / 2])
+	 << ", mean robustness " << best_sum[kind] / conflicts << endl;
+  }
+
+  if(pools.empty()) {
+    return EXIT_SUCCESS;
+  }
+  for(int path = 0; path < PATHS; path++) {
+    cout << "Scoring " << path_names[path] << ":";
+    for(unsigned int i = 0; i < pools.size(); i++) {
+      cout << " " << thread_counts[i] << " threads " << scoring_ms[path][i] / conflicts << " ms ("
+	   << scoring_ms[path][0] / scoring_ms[path][i] << "x)" << (i + 1 < pools.size() ? "," : "");
+    }
+    cout << endl;
+  }
+  if(mismatches) {
+    cout << "FAILED: " << mismatches << " runs differ from the serial path" << endl;
+    return EXIT_FAILURE;
+  }
+  cout << "Scores and chosen actions match the serial path bit for bit" << endl;
+  return EXIT_SUCCESS;
+}